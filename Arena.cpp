@@ -0,0 +1,136 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#include "Arena.h"
+
+namespace
+{
+    constexpr size_t FIRST_BLOCK_SIZE = 4096;
+    constexpr size_t MAX_BLOCK_SIZE = 1 << 20;
+}
+
+Arena::Arena()
+{
+    for (std::atomic<void *> &head: freeLists)
+    {
+        head.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+Arena::~Arena() = default;
+
+std::shared_ptr<Arena> Arena::create()
+{
+    auto *arena = new Arena();
+    arena->owned = true;
+    // the owners count as one live object
+    arena->live.store(1, std::memory_order_relaxed);
+    return std::shared_ptr<Arena>(arena, &Arena::release);
+}
+
+void Arena::keep(std::shared_ptr<const void> object)
+{
+    const std::lock_guard<std::mutex> lock(mutex);
+    kept.push_back(std::move(object));
+}
+
+void Arena::release(Arena *arena)
+{
+    if (arena->live.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        delete arena;
+    }
+}
+
+size_t Arena::sizeClass(const size_t size)
+{
+    return (size + GRANULE - 1) / GRANULE - 1;
+}
+
+size_t Arena::bytesAllocated() const
+{
+    const std::lock_guard<std::mutex> lock(mutex);
+    size_t total = 0;
+    for (const Block &block: blocks)
+    {
+        total += block.size;
+    }
+    return total;
+}
+
+void *Arena::allocate(size_t size, const size_t alignment)
+{
+    live.fetch_add(1, std::memory_order_relaxed);
+    if (size > LARGEST || alignment > GRANULE)
+    {
+        return ::operator new(size, std::align_val_t(alignment));
+    }
+    // a freed allocation has to hold the link of its free list
+    size = std::max(size, sizeof(void *));
+    std::atomic<void *> &free_list = freeLists[sizeClass(size)];
+    size = (sizeClass(size) + 1) * GRANULE;
+
+    const std::lock_guard<std::mutex> lock(mutex);
+    void *reused = free_list.load(std::memory_order_acquire);
+    while (reused != nullptr)
+    {
+        // only one thread pops, so `reused` stays on the list until this exchange
+        void *next;
+        std::memcpy(&next, reused, sizeof(void *));
+        if (free_list.compare_exchange_weak(reused, next, std::memory_order_acquire))
+        {
+            return reused;
+        }
+    }
+
+    if (!blocks.empty())
+    {
+        Block &block = blocks.back();
+        if (block.used + size <= block.size)
+        {
+            void *pointer = block.data.get() + block.used;
+            block.used += size;
+            return pointer;
+        }
+    }
+
+    const size_t block_size = blocks.empty() ? FIRST_BLOCK_SIZE : std::min(blocks.back().size * 2, MAX_BLOCK_SIZE);
+
+    Block block;
+    block.data = std::unique_ptr<std::byte[]>(new std::byte[block_size]);
+    block.size = block_size;
+    // operator new[] aligns to at least alignof(std::max_align_t), every size is a multiple of it
+    block.used = size;
+    blocks.push_back(std::move(block));
+    return blocks.back().data.get();
+}
+
+void Arena::deallocate(void *pointer, size_t size, const size_t alignment)
+{
+    // read before the count drops, another thread may destroy the arena right after
+    const bool owned_arena = owned;
+    if (size > LARGEST || alignment > GRANULE)
+    {
+        ::operator delete(pointer, std::align_val_t(alignment));
+    }
+    else
+    {
+        std::atomic<void *> &free_list = freeLists[sizeClass(std::max(size, sizeof(void *)))];
+        void *head = free_list.load(std::memory_order_relaxed);
+        do
+        {
+            std::memcpy(pointer, &head, sizeof(void *));
+        }
+        while (!free_list.compare_exchange_weak(head, pointer, std::memory_order_release, std::memory_order_relaxed));
+    }
+    // the last object of an arena whose automaton is gone
+    if (live.fetch_sub(1, std::memory_order_acq_rel) == 1 && owned_arena)
+    {
+        delete this;
+    }
+}
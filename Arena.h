@@ -0,0 +1,150 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#ifndef AUTOMATA_ARENA_H
+#define AUTOMATA_ARENA_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// A bump allocator for the objects that make up an automaton and for its indexes.
+// Memory comes from a handful of large blocks instead of one allocation per object. Freed allocations go on
+// a free list per size class and are reused by the next allocation of that class, the blocks themselves are
+// only returned when the arena is destroyed. Large or over-aligned allocations are passed on to operator new.
+// Freeing takes no lock, so releasing a state or transition on any thread costs two atomic operations.
+// An arena from create() is owned by its automaton, the objects in it only point to it. It counts its
+// live objects, so one that is still held when the automaton goes away keeps the arena until it is freed.
+class Arena
+{
+public:
+    Arena();
+
+    Arena(const Arena &) = delete;
+
+    Arena &operator=(const Arena &) = delete;
+
+    ~Arena();
+
+    // destroyed once every owner released it and every object in it is freed
+    static std::shared_ptr<Arena> create();
+
+    void *allocate(size_t size, size_t alignment);
+
+    void deallocate(void *pointer, size_t size, size_t alignment);
+
+    // keeps `object` alive as long as the arena, for data that the objects in it point to
+    void keep(std::shared_ptr<const void> object);
+
+    // allocate_shared in the arena: the object and its control block share one allocation,
+    // which goes back to the arena when the last reference is released
+    template<typename T, typename... Args>
+    static std::shared_ptr<T> make(Arena *arena, Args &&... args);
+
+    [[nodiscard]]
+    size_t bytesAllocated() const;
+
+private:
+    static void release(Arena *arena);
+
+    static size_t sizeClass(size_t size);
+
+private:
+    // allocations up to this size with at most this alignment come from the blocks
+    static constexpr size_t GRANULE = alignof(std::max_align_t);
+    static constexpr size_t LARGEST = 4096;
+
+    struct Block
+    {
+        std::unique_ptr<std::byte[]> data;
+        size_t size = 0;
+        size_t used = 0;
+    };
+
+    // guards the blocks, taking from the free lists and `kept`
+    mutable std::mutex mutex;
+    std::vector<Block> blocks;
+    // freed allocations of each multiple of GRANULE, linked through their first bytes.
+    // pushed without a lock, popped under `mutex` only, so a popped link cannot be reused under a reader
+    std::array<std::atomic<void *>, LARGEST / GRANULE> freeLists;
+    std::vector<std::shared_ptr<const void>> kept;
+    // objects allocated and not freed yet, plus one for the owners of an arena made by create()
+    std::atomic<size_t> live{0};
+    // made by create(), destroyed when `live` drops to zero
+    bool owned = false;
+};
+
+template<typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    // propagated with the container, so a container moved or assigned from another allocates where its
+    // contents live
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    // without an arena the memory comes from operator new
+    explicit ArenaAllocator(Arena *arena = nullptr) : arena(arena)
+    {
+    }
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena)
+    {
+    }
+
+    T *allocate(const size_t n)
+    {
+        if (arena == nullptr)
+        {
+            return std::allocator<T>().allocate(n);
+        }
+        return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *pointer, const size_t n)
+    {
+        if (arena == nullptr)
+        {
+            std::allocator<T>().deallocate(pointer, n);
+            return;
+        }
+        arena->deallocate(pointer, n * sizeof(T), alignof(T));
+    }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U> &other) const
+    {
+        return arena == other.arena;
+    }
+
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U> &other) const
+    {
+        return arena != other.arena;
+    }
+
+    Arena *arena;
+};
+
+template<typename T, typename... Args>
+std::shared_ptr<T> Arena::make(Arena *arena, Args &&... args)
+{
+    if (arena == nullptr)
+    {
+        return std::make_shared<T>(std::forward<Args>(args)...);
+    }
+    return std::allocate_shared<T>(ArenaAllocator<T>(arena), std::forward<Args>(args)...);
+}
+
+
+#endif //AUTOMATA_ARENA_H
@@ -0,0 +1,196 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#include <array>
+#include <map>
+
+#include "BitParallelNFA.h"
+
+BitParallelNFA::BitParallelNFA(const RE &re)
+{
+    const Positions positions = re.getPositions();
+    build(positions.symbols, positions.follow, positions.first, positions.last, positions.nullable);
+}
+
+BitParallelNFA::BitParallelNFA(const NFA &nfa)
+{
+    if (nfa.getType() == "ENFA")
+    {
+        throw std::runtime_error("Bit-parallel matching needs an automaton without epsilon transitions");
+    }
+
+    // one state per (state, symbol) that a transition enters
+    std::map<std::pair<const State *, Symbol>, size_t> split;
+    std::vector<Symbol> symbols;
+    for (const std::shared_ptr<Transition> &transition: nfa.getTransitions())
+    {
+        if (split.emplace(std::make_pair(transition->to.get(), transition->symbol), symbols.size()).second)
+        {
+            symbols.push_back(transition->symbol);
+        }
+    }
+
+    std::vector<std::set<size_t>> follow(symbols.size());
+    std::set<size_t> first;
+    std::set<size_t> last;
+    bool nullable = false;
+    for (const std::shared_ptr<Transition> &transition: nfa.getTransitions())
+    {
+        const size_t to = split.at({transition->to.get(), transition->symbol});
+        if (transition->from->starting)
+        {
+            first.insert(to);
+        }
+        for (const auto &[from, position]: split)
+        {
+            if (from.first == transition->from.get())
+            {
+                follow[position].insert(to);
+            }
+        }
+    }
+    for (const auto &[state, position]: split)
+    {
+        if (state.first->accepting)
+        {
+            last.insert(position);
+        }
+    }
+    for (const std::shared_ptr<State> &state: nfa.getStates())
+    {
+        nullable = nullable || (state->starting && state->accepting);
+    }
+    build(symbols, follow, first, last, nullable);
+}
+
+void BitParallelNFA::build(const std::vector<Symbol> &symbols, const std::vector<std::set<size_t>> &follow,
+                           const std::set<size_t> &first, const std::set<size_t> &last, const bool nullable)
+{
+    states = symbols.size() + 1;
+    if (states > MAX_STATES)
+    {
+        throw std::runtime_error("Too many states for bit-parallel matching");
+    }
+    words = states <= 64 ? 1 : states <= 128 ? 2 : 4;
+
+    auto set = [this](uint64_t *bits, const size_t state) {
+        bits[state / 64] |= uint64_t(1) << (state % 64);
+    };
+
+    masks.assign(256 * words, 0);
+    accepting.assign(words, 0);
+    std::vector<uint64_t> follow_of(states * words, 0);
+    for (const size_t position: first)
+    {
+        set(&follow_of[0], position + 1);
+    }
+    if (nullable)
+    {
+        set(accepting.data(), 0);
+    }
+    for (size_t position = 0; position < symbols.size(); position++)
+    {
+        set(&masks[static_cast<unsigned char>(symbols[position]) * words], position + 1);
+        for (const size_t next: follow[position])
+        {
+            set(&follow_of[(position + 1) * words], next + 1);
+        }
+        if (last.count(position) != 0)
+        {
+            set(accepting.data(), position + 1);
+        }
+    }
+
+    // every entry is the union of the entry without its highest bit and the follow set of that bit
+    const size_t chunks = words * 8;
+    follows.assign(chunks * 256 * words, 0);
+    for (size_t chunk = 0; chunk < chunks; chunk++)
+    {
+        uint64_t *table = &follows[chunk * 256 * words];
+        for (size_t byte = 1; byte < 256; byte++)
+        {
+            size_t high = 7;
+            while (!((byte >> high) & 1))
+            {
+                high--;
+            }
+            const size_t state = chunk * 8 + high;
+            const uint64_t *rest = &table[(byte & ~(size_t(1) << high)) * words];
+            for (size_t word = 0; word < words; word++)
+            {
+                table[byte * words + word] = rest[word] | (state < states ? follow_of[state * words + word] : 0);
+            }
+        }
+    }
+}
+
+bool BitParallelNFA::accepts(const std::string &string) const
+{
+    return accepts(string.data(), string.size());
+}
+
+bool BitParallelNFA::accepts(const char *data, const size_t size) const
+{
+    switch (words)
+    {
+    case 1:
+        return run<1>(data, size);
+    case 2:
+        return run<2>(data, size);
+    default:
+        return run<4>(data, size);
+    }
+}
+
+template<size_t Words>
+bool BitParallelNFA::run(const char *data, const size_t size) const
+{
+    std::array<uint64_t, Words> active{};
+    active[0] = 1;
+    for (size_t i = 0; i < size; i++)
+    {
+        std::array<uint64_t, Words> next{};
+        for (size_t word = 0; word < Words; word++)
+        {
+            for (size_t shift = 0; shift < 64 && (active[word] >> shift) != 0; shift += 8)
+            {
+                const size_t chunk = word * 8 + shift / 8;
+                const uint64_t *entry = &follows[(chunk * 256 + ((active[word] >> shift) & 0xFF)) * Words];
+                for (size_t w = 0; w < Words; w++)
+                {
+                    next[w] |= entry[w];
+                }
+            }
+        }
+
+        const uint64_t *mask = &masks[static_cast<unsigned char>(data[i]) * Words];
+        uint64_t any = 0;
+        for (size_t word = 0; word < Words; word++)
+        {
+            active[word] = next[word] & mask[word];
+            any |= active[word];
+        }
+        if (any == 0)
+        {
+            return false;
+        }
+    }
+
+    uint64_t accepted = 0;
+    for (size_t word = 0; word < Words; word++)
+    {
+        accepted |= active[word] & accepting[word];
+    }
+    return accepted != 0;
+}
+
+size_t BitParallelNFA::size() const
+{
+    return states;
+}
+
+size_t BitParallelNFA::getWords() const
+{
+    return words;
+}
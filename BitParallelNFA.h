@@ -0,0 +1,66 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#ifndef AUTOMATA_BITPARALLELNFA_H
+#define AUTOMATA_BITPARALLELNFA_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "NFA.h"
+#include "RE.h"
+
+// Matches small automata with their whole set of active states in one to four machine words.
+// The automaton is homogeneous: every transition into a state is labelled with the same symbol,
+// as in the position automaton of a regex. A step is then
+//     active = follow(active) & states entered by the symbol
+// where follow is looked up per byte of the active set in precomputed tables, so no state is visited
+// one by one. Bit 0 is the initial state, at most 255 other states fit.
+class BitParallelNFA
+{
+public:
+    static constexpr size_t MAX_STATES = 256;
+
+    // from the position automaton of the regex
+    explicit BitParallelNFA(const RE &re);
+
+    // from an NFA without epsilon transitions, a state is split per symbol it is entered with
+    explicit BitParallelNFA(const NFA &nfa);
+
+    [[nodiscard]]
+    bool accepts(const std::string &string) const;
+
+    [[nodiscard]]
+    bool accepts(const char *data, size_t size) const;
+
+    // the number of states, the initial state included
+    [[nodiscard]]
+    size_t size() const;
+
+    // the number of 64 bit words of an active set: 1, 2 or 4
+    [[nodiscard]]
+    size_t getWords() const;
+
+private:
+    // `follow` and `symbols` exclude the initial state, bit i + 1 stands for state i
+    void build(const std::vector<Symbol> &symbols, const std::vector<std::set<size_t>> &follow,
+               const std::set<size_t> &first, const std::set<size_t> &last, bool nullable);
+
+    template<size_t Words>
+    bool run(const char *data, size_t size) const;
+
+private:
+    size_t states = 0;
+    size_t words = 0;
+
+    // [byte][word], the states entered by each byte
+    std::vector<uint64_t> masks;
+    // [chunk][byte][word], the union of the follow sets of the states whose bits in `chunk` are `byte`
+    std::vector<uint64_t> follows;
+    std::vector<uint64_t> accepting;
+};
+
+
+#endif //AUTOMATA_BITPARALLELNFA_H
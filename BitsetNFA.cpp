@@ -0,0 +1,132 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#include <algorithm>
+
+#include "BitsetNFA.h"
+#include "CSRAutomaton.h"
+
+BitsetNFA::BitsetNFA(const FA &fa) : classes(fa)
+{
+    const CSRAutomaton csr(fa);
+    states = csr.size();
+    words = (states + 63) / 64;
+    start.assign(words, 0);
+    accepting.assign(words, 0);
+
+    // the epsilon closure of every single state
+    std::vector<uint64_t> closures(states * words, 0);
+    std::vector<CSRAutomaton::StateId> set;
+    for (CSRAutomaton::StateId state = 0; state < states; state++)
+    {
+        uint64_t *closure = &closures[state * words];
+        std::vector<uint64_t> in_set(words, 0);
+        set.assign(1, state);
+        in_set[state / 64] |= uint64_t(1) << (state % 64);
+        csr.e_closure(set, in_set);
+        std::copy(in_set.begin(), in_set.end(), closure);
+
+        if (csr.isAccepting(state))
+        {
+            accepting[state / 64] |= uint64_t(1) << (state % 64);
+        }
+    }
+    if (csr.getStartingState() != CSRAutomaton::NO_STATE)
+    {
+        const uint64_t *closure = &closures[csr.getStartingState() * words];
+        for (size_t word = 0; word < words; word++)
+        {
+            start[word] = closure[word] & csr.getLiveStates()[word];
+        }
+    }
+
+    // one byte of every class stands for the class, epsilon is not an input symbol
+    const size_t stride = classes.size();
+    std::vector<int> representative(stride, -1);
+    for (size_t byte = 0; byte < 256; byte++)
+    {
+        const auto symbol = static_cast<Symbol>(byte);
+        if (representative[classes.get(symbol)] == -1 && (fa.getEpsilon() == '\0' || symbol != fa.getEpsilon()))
+        {
+            representative[classes.get(symbol)] = static_cast<int>(byte);
+        }
+    }
+
+    successors.assign(states * stride * words, 0);
+    for (CSRAutomaton::StateId state = 0; state < states; state++)
+    {
+        for (size_t byte_class = 0; byte_class < stride; byte_class++)
+        {
+            if (representative[byte_class] == -1)
+            {
+                continue;
+            }
+            uint64_t *row = &successors[(state * stride + byte_class) * words];
+            const CSRAutomaton::Edges edges =
+                    csr.getTransitionsFromState(state, static_cast<Symbol>(representative[byte_class]));
+            for (size_t edge = edges.first; edge < edges.last; edge++)
+            {
+                const uint64_t *closure = &closures[csr.getTarget(edge) * words];
+                for (size_t word = 0; word < words; word++)
+                {
+                    row[word] |= closure[word] & csr.getLiveStates()[word];
+                }
+            }
+        }
+    }
+}
+
+bool BitsetNFA::accepts(const std::string &string) const
+{
+    return accepts(string.data(), string.size());
+}
+
+bool BitsetNFA::accepts(const char *data, const size_t size) const
+{
+    const size_t stride = classes.size();
+    std::vector<uint64_t> current = start;
+    std::vector<uint64_t> next(words);
+    for (size_t i = 0; i < size; i++)
+    {
+        const uint8_t byte_class = classes.get(data[i]);
+        std::fill(next.begin(), next.end(), 0);
+        for (size_t word = 0; word < words; word++)
+        {
+            for (uint64_t bits = current[word]; bits != 0; bits &= bits - 1)
+            {
+                const size_t state = word * 64 + __builtin_ctzll(bits);
+                const uint64_t *row = &successors[(state * stride + byte_class) * words];
+                for (size_t w = 0; w < words; w++)
+                {
+                    next[w] |= row[w];
+                }
+            }
+        }
+        // only live states are ever set, an empty set can not accept anymore
+        if (std::all_of(next.begin(), next.end(), [](const uint64_t bits) { return bits == 0; }))
+        {
+            return false;
+        }
+        std::swap(current, next);
+    }
+
+    for (size_t word = 0; word < words; word++)
+    {
+        if (current[word] & accepting[word])
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t BitsetNFA::size() const
+{
+    return states;
+}
+
+size_t BitsetNFA::memoryUsage() const
+{
+    return (successors.capacity() + start.capacity() + accepting.capacity()) * sizeof(uint64_t);
+}
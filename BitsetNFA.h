@@ -0,0 +1,54 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#ifndef AUTOMATA_BITSETNFA_H
+#define AUTOMATA_BITSETNFA_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "FA.h"
+#include "ByteClasses.h"
+
+// Simulates an NFA or ENFA directly, without determinizing it.
+// The set of active states is a dense bitset. For every (state, byte class) the epsilon closure of its
+// successors is precomputed, so a step is an OR of one row per active state and costs O(|Q|/64) words
+// per active state. Memory is |Q| * classes * |Q| / 64 words however large the subset construction
+// would get. States that can not reach an accepting state are masked out of every row, so the active set
+// becomes empty, and the match stops, as soon as the input can no longer be accepted.
+class BitsetNFA
+{
+public:
+    explicit BitsetNFA(const FA &fa);
+
+    [[nodiscard]]
+    bool accepts(const std::string &string) const;
+
+    [[nodiscard]]
+    bool accepts(const char *data, size_t size) const;
+
+    // the number of states
+    [[nodiscard]]
+    size_t size() const;
+
+    // the number of bytes used by the bitsets
+    [[nodiscard]]
+    size_t memoryUsage() const;
+
+private:
+    ByteClasses classes;
+    size_t states = 0;
+    // 64 bit words per bitset
+    size_t words = 0;
+
+    // row-major [state][class][word], the live part of the epsilon closure of the successors
+    std::vector<uint64_t> successors;
+    // the live part of the epsilon closure of the starting state
+    std::vector<uint64_t> start;
+    std::vector<uint64_t> accepting;
+};
+
+
+#endif //AUTOMATA_BITSETNFA_H
@@ -0,0 +1,87 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#include <map>
+
+#include "ByteClasses.h"
+
+ByteClasses::ByteClasses() = default;
+
+ByteClasses::ByteClasses(const FA &fa)
+{
+    // the signature of a byte is the sorted list of edges labelled with it
+    std::array<std::vector<std::pair<const State *, const State *>>, 256> signatures;
+    // epsilon never shares a class with an input symbol
+    if (fa.getEpsilon() != '\0')
+    {
+        signatures[static_cast<unsigned char>(fa.getEpsilon())].emplace_back(nullptr, nullptr);
+    }
+    for (const std::shared_ptr<Transition> &transition: fa.getTransitions())
+    {
+        signatures[static_cast<unsigned char>(transition->symbol)].emplace_back(
+                transition->from.get(), transition->to.get());
+    }
+
+    std::map<std::vector<std::pair<const State *, const State *>>, uint8_t> known;
+    count = 0;
+    for (size_t byte = 0; byte < 256; byte++)
+    {
+        std::sort(signatures[byte].begin(), signatures[byte].end());
+        auto found = known.emplace(std::move(signatures[byte]), static_cast<uint8_t>(count));
+        if (found.second)
+        {
+            count++;
+        }
+        classes[byte] = found.first->second;
+    }
+}
+
+ByteClasses::ByteClasses(const ByteClasses &first, const ByteClasses &second)
+{
+    std::map<std::pair<uint8_t, uint8_t>, uint8_t> known;
+    count = 0;
+    for (size_t byte = 0; byte < 256; byte++)
+    {
+        auto found = known.emplace(std::make_pair(first.classes[byte], second.classes[byte]),
+                                   static_cast<uint8_t>(count));
+        if (found.second)
+        {
+            count++;
+        }
+        classes[byte] = found.first->second;
+    }
+}
+
+uint8_t ByteClasses::get(const Symbol symbol) const
+{
+    return classes[static_cast<unsigned char>(symbol)];
+}
+
+size_t ByteClasses::size() const
+{
+    return count;
+}
+
+std::vector<std::vector<Symbol>> ByteClasses::partition(const std::set<Symbol> &alphabet) const
+{
+    std::vector<std::vector<Symbol>> groups;
+    std::array<int, 256> group_of{};
+    group_of.fill(-1);
+    for (const Symbol symbol: alphabet)
+    {
+        int &group = group_of[get(symbol)];
+        if (group == -1)
+        {
+            group = static_cast<int>(groups.size());
+            groups.emplace_back();
+        }
+        groups[group].push_back(symbol);
+    }
+    return groups;
+}
+
+const std::array<uint8_t, 256> &ByteClasses::getMap() const
+{
+    return classes;
+}
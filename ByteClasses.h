@@ -0,0 +1,48 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#ifndef AUTOMATA_BYTECLASSES_H
+#define AUTOMATA_BYTECLASSES_H
+
+#include <array>
+#include <cstdint>
+#include <set>
+#include <vector>
+
+#include "FA.h"
+
+// A partition of the 256 byte values into classes that an automaton cannot tell apart:
+// two bytes share a class when every state has exactly the same transitions on both of them.
+class ByteClasses
+{
+public:
+    // a single class holding every byte
+    ByteClasses();
+
+    explicit ByteClasses(const FA &fa);
+
+    // the coarsest partition that refines both `first` and `second`
+    ByteClasses(const ByteClasses &first, const ByteClasses &second);
+
+    [[nodiscard]]
+    uint8_t get(Symbol symbol) const;
+
+    // the number of classes, at most 256
+    [[nodiscard]]
+    size_t size() const;
+
+    // the symbols of `alphabet` grouped by class, groups are ordered by their first symbol
+    [[nodiscard]]
+    std::vector<std::vector<Symbol>> partition(const std::set<Symbol> &alphabet) const;
+
+    [[nodiscard]]
+    const std::array<uint8_t, 256> &getMap() const;
+
+private:
+    std::array<uint8_t, 256> classes{};
+    size_t count = 1;
+};
+
+
+#endif //AUTOMATA_BYTECLASSES_H
@@ -0,0 +1,524 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#include <algorithm>
+#include <fstream>
+
+#include "CSRAutomaton.h"
+
+CSRAutomaton::CSRAutomaton() = default;
+
+CSRAutomaton::CSRAutomaton(const FA &fa)
+        : type(fa.getType()), alphabet(fa.getAlphabet()), epsilon(fa.getEpsilon())
+{
+    const std::vector<std::shared_ptr<State>> &fa_states = fa.getStates();
+
+    if (fa_states.size() >= NO_STATE)
+    {
+        throw std::runtime_error("too many states");
+    }
+    std::unordered_map<const State *, StateId> ids;
+    ids.reserve(fa_states.size());
+    parts.reserve(fa_states.size());
+    accepting.assign((fa_states.size() + 63) / 64, 0);
+    starting.assign((fa_states.size() + 63) / 64, 0);
+    for (const std::shared_ptr<State> &state: fa_states)
+    {
+        const StateId id = static_cast<StateId>(ids.size());
+        ids.emplace(state.get(), id);
+        addName(*state);
+        if (state->accepting)
+        {
+            set(accepting, id);
+        }
+        if (state->starting)
+        {
+            set(starting, id);
+        }
+        if (state == fa.getStartingState())
+        {
+            startingState = id;
+        }
+    }
+
+    std::vector<RawTransition> raw;
+    raw.reserve(fa.getTransitions().size());
+    for (const std::shared_ptr<Transition> &transition: fa.getTransitions())
+    {
+        auto from = ids.find(transition->from.get());
+        auto to = ids.find(transition->to.get());
+        if (from != ids.end() && to != ids.end())
+        {
+            raw.push_back({from->second, to->second, transition->symbol});
+        }
+    }
+    build(raw);
+}
+
+void CSRAutomaton::fromPath(const std::string &file_path)
+{
+    std::ifstream input_file(file_path);
+    json j;
+
+    if (input_file.fail())
+    {
+        throw std::runtime_error("file could not be found: " + file_path);
+    }
+
+    input_file >> j;
+
+    fromJSON(j);
+}
+
+void CSRAutomaton::fromJSON(const json &j)
+{
+    if (!j["type"].is_string())
+    {
+        throw std::runtime_error("Automata type should be of type string");
+    }
+    if (!j["alphabet"].is_array())
+    {
+        throw std::runtime_error("Invalid alphabet type, must be of type array");
+    }
+    if (!j["states"].is_array())
+    {
+        throw std::runtime_error("Invalid states type, must be of type array");
+    }
+    if (!j["transitions"].is_array())
+    {
+        throw std::runtime_error("Invalid transitions type, must be of type array");
+    }
+
+    *this = CSRAutomaton();
+    type = j["type"].get<std::string>();
+    const bool allowEpsilonTransitions = type == "ENFA";
+    if (allowEpsilonTransitions)
+    {
+        if (!j["eps"].is_string() || j["eps"].get_ref<const std::string &>().empty())
+        {
+            throw std::runtime_error("Epsilon transitions are allowed, but no symbol was provided");
+        }
+        epsilon = j["eps"].get_ref<const std::string &>().front();
+    }
+
+    for (const json &letter: j["alphabet"])
+    {
+        if (!letter.is_string() || letter.get_ref<const std::string &>().size() != SYMBOL_SIZE)
+        {
+            throw std::runtime_error("symbol must be a string of size 1");
+        }
+        alphabet.insert(letter.get_ref<const std::string &>().front());
+    }
+
+    // the views point into `j`, which outlives the loading
+    std::unordered_map<std::string_view, StateId> loading_ids;
+    loading_ids.reserve(j["states"].size());
+    accepting.assign((j["states"].size() + 63) / 64, 0);
+    starting.assign((j["states"].size() + 63) / 64, 0);
+    for (const json &state: j["states"])
+    {
+        if (!state.is_object() || !state["name"].is_string()
+            || !state["starting"].is_boolean() || !state["accepting"].is_boolean())
+        {
+            throw std::runtime_error("state must be an object with a name, starting and accepting attribute");
+        }
+        const std::string &name = state["name"].get_ref<const std::string &>();
+        const StateId id = static_cast<StateId>(loading_ids.size());
+        if (!loading_ids.emplace(name, id).second)
+        {
+            continue;
+        }
+        addName(name);
+        if (state["accepting"].get<bool>())
+        {
+            set(accepting, id);
+        }
+        if (state["starting"].get<bool>())
+        {
+            if (startingState != NO_STATE)
+            {
+                throw std::runtime_error("cannot have multiple instances of starting states");
+            }
+            set(starting, id);
+            startingState = id;
+        }
+    }
+    if (startingState == NO_STATE)
+    {
+        throw std::runtime_error("no starting state provided");
+    }
+
+    std::vector<RawTransition> raw;
+    raw.reserve(j["transitions"].size());
+    for (const json &transition: j["transitions"])
+    {
+        if (!transition.is_object() || !transition["from"].is_string() || !transition["to"].is_string()
+            || !transition["input"].is_string())
+        {
+            throw std::runtime_error("transition must be an object with a from, to and input attribute");
+        }
+        if (transition["input"].get_ref<const std::string &>().size() != SYMBOL_SIZE)
+        {
+            throw std::runtime_error("transition input attribute must be of size 1");
+        }
+        auto from = loading_ids.find(transition["from"].get_ref<const std::string &>());
+        auto to = loading_ids.find(transition["to"].get_ref<const std::string &>());
+        if (from == loading_ids.end() || to == loading_ids.end())
+        {
+            throw std::runtime_error("transition from and to attributes must be part of states");
+        }
+        const Symbol symbol = transition["input"].get_ref<const std::string &>().front();
+        if (alphabet.count(symbol) == 0 && allowEpsilonTransitions && symbol != epsilon)
+        {
+            throw std::runtime_error(
+                    "transition input attribute must be part of alphabet, got: " + std::string(1, symbol));
+        }
+        raw.push_back({from->second, to->second, symbol});
+    }
+    build(raw);
+}
+
+void CSRAutomaton::toFA(FA &fa) const
+{
+    fa.setAlphabet(alphabet);
+    fa.setEpsilon(epsilon);
+
+    std::vector<std::shared_ptr<State>> fa_states;
+    fa_states.reserve(size());
+    for (StateId state = 0; state < size(); state++)
+    {
+        fa_states.push_back(fa.newState(std::string(getName(state)), isStarting(state), isAccepting(state)));
+        fa.addState(fa_states.back());
+    }
+
+    // the edges are unique by construction
+    std::vector<std::shared_ptr<Transition>> fa_transitions;
+    fa_transitions.reserve(transitionCount());
+    for (StateId state = 0; state < size(); state++)
+    {
+        for (size_t edge = offsets[state]; edge < offsets[state + 1]; edge++)
+        {
+            fa_transitions.push_back(fa.newTransition(fa_states[state], fa_states[targets[edge]], symbols[edge]));
+        }
+    }
+    fa.addUniqueTransitions(fa_transitions);
+}
+
+bool CSRAutomaton::accepts(const std::string &string) const
+{
+    if (startingState == NO_STATE)
+    {
+        return false;
+    }
+
+    std::vector<StateId> current = {startingState};
+    std::vector<uint64_t> in_current((size() + 63) / 64, 0);
+    set(in_current, startingState);
+    e_closure(current, in_current);
+
+    std::vector<StateId> next;
+    std::vector<uint64_t> in_next(in_current.size(), 0);
+    for (const Symbol c: string)
+    {
+        next.clear();
+        for (const StateId state: current)
+        {
+            const Edges edges = getTransitionsFromState(state, c);
+            for (size_t edge = edges.first; edge < edges.last; edge++)
+            {
+                if (!test(in_next, targets[edge]))
+                {
+                    set(in_next, targets[edge]);
+                    next.push_back(targets[edge]);
+                }
+            }
+        }
+        e_closure(next, in_next);
+        if (next.empty())
+        {
+            return false;
+        }
+
+        for (const StateId state: current)
+        {
+            in_current[state / 64] = 0;
+        }
+        std::swap(current, next);
+        std::swap(in_current, in_next);
+    }
+
+    return std::any_of(current.begin(), current.end(), [this](const StateId state) { return isAccepting(state); });
+}
+
+const std::string &CSRAutomaton::getType() const
+{
+    return type;
+}
+
+const std::set<Symbol> &CSRAutomaton::getAlphabet() const
+{
+    return alphabet;
+}
+
+Symbol CSRAutomaton::getEpsilon() const
+{
+    return epsilon;
+}
+
+size_t CSRAutomaton::size() const
+{
+    return stateCount;
+}
+
+size_t CSRAutomaton::transitionCount() const
+{
+    return targets.size();
+}
+
+CSRAutomaton::StateId CSRAutomaton::getStartingState() const
+{
+    return startingState;
+}
+
+CSRAutomaton::StateId CSRAutomaton::getState(const std::string_view name) const
+{
+    const std::hash<std::string_view> hash;
+    if (stateIds.empty() && size() != 0)
+    {
+        stateIds.reserve(size());
+        for (StateId state = 0; state < size(); state++)
+        {
+            stateIds.emplace(hash(getName(state)), state);
+        }
+    }
+    auto range = stateIds.equal_range(hash(name));
+    for (auto found = range.first; found != range.second; ++found)
+    {
+        if (getName(found->second) == name)
+        {
+            return found->second;
+        }
+    }
+    return NO_STATE;
+}
+
+std::string_view CSRAutomaton::getName(const StateId state) const
+{
+    if (!parts.empty())
+    {
+        return parts[state].names->get(parts[state].id);
+    }
+    return std::string_view(names).substr(nameOffsets[state], nameOffsets[state + 1] - nameOffsets[state]);
+}
+
+bool CSRAutomaton::isStarting(const StateId state) const
+{
+    return test(starting, state);
+}
+
+bool CSRAutomaton::isAccepting(const StateId state) const
+{
+    return test(accepting, state);
+}
+
+bool CSRAutomaton::isLive(const StateId state) const
+{
+    return test(live, state);
+}
+
+const std::vector<uint64_t> &CSRAutomaton::getLiveStates() const
+{
+    return live;
+}
+
+CSRAutomaton::Edges CSRAutomaton::getTransitionsFromState(const StateId state) const
+{
+    return {offsets[state], offsets[state + 1]};
+}
+
+CSRAutomaton::Edges CSRAutomaton::getTransitionsFromState(const StateId state, const Symbol symbol) const
+{
+    auto first = symbols.begin() + offsets[state];
+    auto last = symbols.begin() + offsets[state + 1];
+    auto range = std::equal_range(first, last, symbol);
+    return {static_cast<size_t>(range.first - symbols.begin()), static_cast<size_t>(range.second - symbols.begin())};
+}
+
+Symbol CSRAutomaton::getSymbol(const size_t edge) const
+{
+    return symbols[edge];
+}
+
+CSRAutomaton::StateId CSRAutomaton::getTarget(const size_t edge) const
+{
+    return targets[edge];
+}
+
+CSRAutomaton::StateId CSRAutomaton::getNextState(const StateId state, const Symbol symbol) const
+{
+    const Edges edges = getTransitionsFromState(state, symbol);
+    if (edges.empty())
+    {
+        return NO_STATE;
+    }
+    return targets[edges.first];
+}
+
+void CSRAutomaton::e_closure(std::vector<StateId> &set_of_states, std::vector<uint64_t> &in_set) const
+{
+    for (size_t i = 0; i < set_of_states.size(); i++)
+    {
+        const Edges edges = getTransitionsFromState(set_of_states[i], epsilon);
+        for (size_t edge = edges.first; edge < edges.last; edge++)
+        {
+            if (!test(in_set, targets[edge]))
+            {
+                set(in_set, targets[edge]);
+                set_of_states.push_back(targets[edge]);
+            }
+        }
+    }
+}
+
+size_t CSRAutomaton::memoryUsage() const
+{
+    return offsets.capacity() * sizeof(uint32_t)
+           + symbols.capacity() * sizeof(Symbol)
+           + targets.capacity() * sizeof(StateId)
+           + (accepting.capacity() + starting.capacity() + live.capacity()) * sizeof(uint64_t)
+           + names.capacity()
+           + nameOffsets.capacity() * sizeof(uint32_t)
+           + parts.capacity() * sizeof(StateNames::Part)
+           + nameTables.capacity() * sizeof(std::shared_ptr<const StateNames>);
+}
+
+void CSRAutomaton::build(std::vector<RawTransition> &raw)
+{
+    if (raw.size() >= UINT32_MAX)
+    {
+        throw std::runtime_error("too many transitions");
+    }
+
+    std::sort(raw.begin(), raw.end(), [](const RawTransition &a, const RawTransition &b) {
+        if (a.from != b.from)
+        {
+            return a.from < b.from;
+        }
+        if (a.symbol != b.symbol)
+        {
+            return a.symbol < b.symbol;
+        }
+        return a.to < b.to;
+    });
+    raw.erase(std::unique(raw.begin(), raw.end(), [](const RawTransition &a, const RawTransition &b) {
+        return a.from == b.from && a.symbol == b.symbol && a.to == b.to;
+    }), raw.end());
+
+    offsets.assign(size() + 1, 0);
+    symbols.resize(raw.size());
+    targets.resize(raw.size());
+    for (size_t edge = 0; edge < raw.size(); edge++)
+    {
+        offsets[raw[edge].from + 1]++;
+        symbols[edge] = raw[edge].symbol;
+        targets[edge] = raw[edge].to;
+    }
+    for (size_t state = 0; state < size(); state++)
+    {
+        offsets[state + 1] += offsets[state];
+    }
+
+    raw.clear();
+    raw.shrink_to_fit();
+    findLiveStates();
+    names.shrink_to_fit();
+    nameOffsets.shrink_to_fit();
+    parts.shrink_to_fit();
+    stateIds.clear();
+}
+
+void CSRAutomaton::findLiveStates()
+{
+    // the edges reversed, in the same compressed form
+    std::vector<uint32_t> reverse_offsets(size() + 1, 0);
+    for (const StateId to: targets)
+    {
+        reverse_offsets[to + 1]++;
+    }
+    for (size_t state = 0; state < size(); state++)
+    {
+        reverse_offsets[state + 1] += reverse_offsets[state];
+    }
+    std::vector<StateId> sources(targets.size());
+    std::vector<uint32_t> fill(reverse_offsets.begin(), reverse_offsets.end() - 1);
+    for (StateId from = 0; from < size(); from++)
+    {
+        for (size_t edge = offsets[from]; edge < offsets[from + 1]; edge++)
+        {
+            sources[fill[targets[edge]]++] = from;
+        }
+    }
+
+    live.assign((size() + 63) / 64, 0);
+    std::vector<StateId> work;
+    for (StateId state = 0; state < size(); state++)
+    {
+        if (isAccepting(state))
+        {
+            set(live, state);
+            work.push_back(state);
+        }
+    }
+    while (!work.empty())
+    {
+        const StateId state = work.back();
+        work.pop_back();
+        for (size_t edge = reverse_offsets[state]; edge < reverse_offsets[state + 1]; edge++)
+        {
+            if (!test(live, sources[edge]))
+            {
+                set(live, sources[edge]);
+                work.push_back(sources[edge]);
+            }
+        }
+    }
+}
+
+void CSRAutomaton::addName(const std::string_view name)
+{
+    if (nameOffsets.empty())
+    {
+        nameOffsets.push_back(0);
+    }
+    if (names.size() + name.size() > UINT32_MAX)
+    {
+        throw std::runtime_error("state names too long");
+    }
+    names.append(name);
+    nameOffsets.push_back(static_cast<uint32_t>(names.size()));
+    stateCount++;
+}
+
+void CSRAutomaton::addName(const State &state)
+{
+    const StateNames::Part part = state.asPart();
+    if (std::none_of(nameTables.begin(), nameTables.end(), [&part](const std::shared_ptr<const StateNames> &table) {
+        return table.get() == part.names;
+    }))
+    {
+        nameTables.push_back(part.names->shared_from_this());
+    }
+    parts.push_back(part);
+    stateCount++;
+}
+
+bool CSRAutomaton::test(const std::vector<uint64_t> &bits, const size_t index)
+{
+    return (bits[index / 64] >> (index % 64)) & 1;
+}
+
+void CSRAutomaton::set(std::vector<uint64_t> &bits, const size_t index)
+{
+    bits[index / 64] |= uint64_t(1) << (index % 64);
+}
@@ -0,0 +1,167 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#ifndef AUTOMATA_CSRAUTOMATON_H
+#define AUTOMATA_CSRAUTOMATON_H
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "FA.h"
+
+// Compact struct-of-arrays storage for (very) large automata.
+// The transitions are kept in compressed sparse row form: the edges of state s are
+// symbols[offsets[s]..offsets[s + 1]) and targets[...], sorted by (symbol, target),
+// which costs 5 bytes per edge instead of a heap allocated Transition.
+// States are identified by their index. The names of a loaded automaton are stored back to back in one
+// buffer, one built from an FA refers to the names of its states, so derived states stay unnamed until asked.
+class CSRAutomaton
+{
+public:
+    using StateId = uint32_t;
+
+    static constexpr StateId NO_STATE = UINT32_MAX;
+
+    // a half open range of edge indices
+    struct Edges
+    {
+        size_t first = 0;
+        size_t last = 0;
+
+        [[nodiscard]]
+        bool empty() const
+        {
+            return first == last;
+        }
+    };
+
+    CSRAutomaton();
+
+    explicit CSRAutomaton(const FA &fa);
+
+    // loads an automaton of any type without building the State/Transition graph
+    void fromPath(const std::string &file_path);
+
+    void fromJSON(const json &j);
+
+    // rebuilds the automaton as a regular FA, `fa` must be empty and of the right type
+    void toFA(FA &fa) const;
+
+    [[nodiscard]]
+    bool accepts(const std::string &string) const;
+
+    [[nodiscard]]
+    const std::string &getType() const;
+
+    [[nodiscard]]
+    const std::set<Symbol> &getAlphabet() const;
+
+    [[nodiscard]]
+    Symbol getEpsilon() const;
+
+    [[nodiscard]]
+    size_t size() const;
+
+    [[nodiscard]]
+    size_t transitionCount() const;
+
+    [[nodiscard]]
+    StateId getStartingState() const;
+
+    [[nodiscard]]
+    StateId getState(std::string_view name) const;
+
+    [[nodiscard]]
+    std::string_view getName(StateId state) const;
+
+    [[nodiscard]]
+    bool isStarting(StateId state) const;
+
+    [[nodiscard]]
+    bool isAccepting(StateId state) const;
+
+    // whether an accepting state can still be reached from `state`
+    [[nodiscard]]
+    bool isLive(StateId state) const;
+
+    // a bitmap of size() bits with the live states set
+    [[nodiscard]]
+    const std::vector<uint64_t> &getLiveStates() const;
+
+    [[nodiscard]]
+    Edges getTransitionsFromState(StateId state) const;
+
+    [[nodiscard]]
+    Edges getTransitionsFromState(StateId state, Symbol symbol) const;
+
+    [[nodiscard]]
+    Symbol getSymbol(size_t edge) const;
+
+    [[nodiscard]]
+    StateId getTarget(size_t edge) const;
+
+    [[nodiscard]]
+    StateId getNextState(StateId state, Symbol symbol) const;
+
+    // adds every state reachable over epsilon transitions from `set` to it,
+    // `in_set` is a bitmap of size() bits that mirrors `set`
+    void e_closure(std::vector<StateId> &set, std::vector<uint64_t> &in_set) const;
+
+    // the number of bytes used by the arrays
+    [[nodiscard]]
+    size_t memoryUsage() const;
+
+private:
+    struct RawTransition
+    {
+        StateId from;
+        StateId to;
+        Symbol symbol;
+    };
+
+    void build(std::vector<RawTransition> &raw);
+
+    // reverse reachability from the accepting states
+    void findLiveStates();
+
+    void addName(std::string_view name);
+
+    // refers to the name of a state of an FA, keeping its table alive
+    void addName(const State &state);
+
+    static bool test(const std::vector<uint64_t> &bits, size_t index);
+
+    static void set(std::vector<uint64_t> &bits, size_t index);
+
+private:
+    std::string type;
+    std::set<Symbol> alphabet;
+    Symbol epsilon = '\0';
+
+    std::vector<uint32_t> offsets;
+    std::vector<Symbol> symbols;
+    std::vector<StateId> targets;
+    std::vector<uint64_t> accepting;
+    std::vector<uint64_t> starting;
+    std::vector<uint64_t> live;
+    StateId startingState = NO_STATE;
+    size_t stateCount = 0;
+
+    // either loaded names ...
+    std::string names;
+    std::vector<uint32_t> nameOffsets;
+    // ... or those of the states of an FA
+    std::vector<StateNames::Part> parts;
+    std::vector<std::shared_ptr<const StateNames>> nameTables;
+    // hash of the name -> state, only built when a state is looked up by name.
+    // keyed by the hash instead of views into `names`, so copies and moves need no fixing up
+    mutable std::unordered_multimap<size_t, StateId> stateIds;
+};
+
+
+#endif //AUTOMATA_CSRAUTOMATON_H
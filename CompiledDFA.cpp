@@ -0,0 +1,546 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#include <algorithm>
+#include <array>
+#include <exception>
+#include <thread>
+#include <unordered_map>
+
+#include "CompiledDFA.h"
+#include "DFA.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define AUTOMATA_AVX2_KERNEL
+#include <immintrin.h>
+#endif
+
+CompiledDFA::CompiledDFA(const DFA &dfa) : classes(dfa)
+{
+    stride = classes.size();
+
+    const std::vector<std::shared_ptr<State>> &states = dfa.getStates();
+
+    std::unordered_map<const State *, int32_t> ids;
+    ids.reserve(states.size());
+    for (const std::shared_ptr<State> &state: states)
+    {
+        ids.emplace(state.get(), static_cast<int32_t>(ids.size()));
+    }
+
+    deadState = static_cast<int32_t>(states.size());
+    table.assign((states.size() + 1) * stride, deadState);
+    accepting.assign((states.size() + 1 + 63) / 64, 0);
+
+    for (const std::shared_ptr<State> &state: states)
+    {
+        if (state->accepting)
+        {
+            const int32_t id = ids[state.get()];
+            accepting[id / 64] |= uint64_t(1) << (id % 64);
+        }
+    }
+
+    for (const std::shared_ptr<Transition> &transition: dfa.getTransitions())
+    {
+        auto from = ids.find(transition->from.get());
+        auto to = ids.find(transition->to.get());
+        if (from == ids.end() || to == ids.end())
+        {
+            continue;
+        }
+        int32_t &entry = table[from->second * stride + classes.get(transition->symbol)];
+        // the first transition wins, like FA::getNextState
+        if (entry == deadState)
+        {
+            entry = to->second;
+        }
+    }
+
+    startingState = deadState;
+    if (dfa.getStartingState() != nullptr)
+    {
+        auto start = ids.find(dfa.getStartingState().get());
+        if (start != ids.end())
+        {
+            startingState = start->second;
+        }
+    }
+    analyze();
+}
+
+CompiledDFA::CompiledDFA(const ByteClasses &classes, std::vector<int32_t> table, std::vector<uint64_t> accepting,
+                         const int32_t startingState)
+        : classes(classes), stride(classes.size()), table(std::move(table)), accepting(std::move(accepting)),
+          startingState(startingState)
+{
+    deadState = static_cast<int32_t>(this->table.size() / stride) - 1;
+    analyze();
+}
+
+void CompiledDFA::analyze()
+{
+    const auto rows = static_cast<int32_t>(size());
+
+    std::vector<std::vector<int32_t>> predecessors(rows);
+    for (int32_t from = 0; from < rows; from++)
+    {
+        for (size_t byte_class = 0; byte_class < stride; byte_class++)
+        {
+            predecessors[table[from * stride + byte_class]].push_back(from);
+        }
+    }
+
+    // live states can still reach an accepting state, the others behave like the dead state
+    std::vector<bool> live(rows, false);
+    std::vector<int32_t> work;
+    for (int32_t state = 0; state < rows; state++)
+    {
+        if (isAccepting(state))
+        {
+            live[state] = true;
+            work.push_back(state);
+        }
+    }
+    while (!work.empty())
+    {
+        const int32_t state = work.back();
+        work.pop_back();
+        for (const int32_t from: predecessors[state])
+        {
+            if (!live[from])
+            {
+                live[from] = true;
+                work.push_back(from);
+            }
+        }
+    }
+
+    // sinks are accepting states that can only reach other sinks, they accept every continuation
+    std::vector<bool> sink(rows, false);
+    for (int32_t state = 0; state < rows; state++)
+    {
+        sink[state] = isAccepting(state);
+        if (!sink[state])
+        {
+            work.push_back(state);
+        }
+    }
+    while (!work.empty())
+    {
+        const int32_t state = work.back();
+        work.pop_back();
+        for (const int32_t from: predecessors[state])
+        {
+            if (sink[from])
+            {
+                sink[from] = false;
+                work.push_back(from);
+            }
+        }
+    }
+    acceptSink = -1;
+    for (int32_t state = 0; state < rows && acceptSink == -1; state++)
+    {
+        if (sink[state])
+        {
+            acceptSink = state;
+        }
+    }
+
+    // every transition into a dead or sink state now goes to the one representative,
+    // so a matcher only has to compare against two states to know the answer
+    auto redirect = [&](const int32_t state) {
+        if (!live[state])
+        {
+            return deadState;
+        }
+        return sink[state] ? acceptSink : state;
+    };
+    for (int32_t &entry: table)
+    {
+        entry = redirect(entry);
+    }
+    startingState = redirect(startingState);
+}
+
+bool CompiledDFA::accepts(const std::string &string) const
+{
+    return accepts(string.data(), string.size());
+}
+
+bool CompiledDFA::accepts(const char *data, const size_t size) const
+{
+    return isAccepting(run(startingState, data, size));
+}
+
+int32_t CompiledDFA::run(int32_t state, const char *data, const size_t size) const
+{
+    // the dead state and the accept sink are only checked between blocks, to keep the inner loop tight
+    constexpr size_t BLOCK = 32;
+
+    const int32_t *next = table.data();
+    const uint8_t *byte_class = classes.getMap().data();
+    const size_t columns = stride;
+    const auto *bytes = reinterpret_cast<const unsigned char *>(data);
+    const unsigned char *end = bytes + size;
+
+    while (bytes != end && !isDecided(state))
+    {
+        const unsigned char *block_end = bytes + std::min(BLOCK, static_cast<size_t>(end - bytes));
+        while (bytes != block_end)
+        {
+            state = next[state * columns + byte_class[*bytes++]];
+        }
+    }
+    return state;
+}
+
+bool CompiledDFA::acceptsParallel(const char *data, const size_t size, size_t threads) const
+{
+    // below this a thread is not worth starting
+    constexpr size_t MIN_CHUNK = 1 << 16;
+
+    const size_t states = this->size();
+    threads = std::min(threads, size / std::max(MIN_CHUNK, states * 64));
+    if (threads < 2)
+    {
+        return accepts(data, size);
+    }
+
+    const size_t chunk = size / threads;
+    // a worker gives up once its runs would cost more than matching the rest of the input in one go,
+    // its chunk is then matched after the first one
+    const size_t budget = size - chunk;
+    std::vector<std::vector<int32_t>> summaries(threads);
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    // a joinable thread terminates the program when it is destroyed, so the started workers are also
+    // joined when starting the next one throws
+    struct Join
+    {
+        std::vector<std::thread> &workers;
+
+        ~Join()
+        {
+            for (std::thread &worker: workers)
+            {
+                if (worker.joinable())
+                {
+                    worker.join();
+                }
+            }
+        }
+    } join{workers};
+
+    for (size_t i = 1; i < threads; i++)
+    {
+        const size_t begin = i * chunk;
+        const size_t end = i + 1 == threads ? size : begin + chunk;
+        workers.emplace_back([this, &summaries, &errors, i, data, begin, end, budget]() {
+            try
+            {
+                summaries[i] = summarize(data + begin, end - begin, budget);
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+    // the first chunk is the only one with a known starting state
+    int32_t state = run(startingState, data, chunk);
+    for (std::thread &worker: workers)
+    {
+        worker.join();
+    }
+    for (size_t i = 1; i < threads; i++)
+    {
+        if (errors[i] != nullptr)
+        {
+            std::rethrow_exception(errors[i]);
+        }
+        if (summaries[i].empty())
+        {
+            const size_t begin = i * chunk;
+            const size_t end = i + 1 == threads ? size : begin + chunk;
+            state = run(state, data + begin, end - begin);
+        }
+        else
+        {
+            state = summaries[i][state];
+        }
+    }
+    return isAccepting(state);
+}
+
+std::vector<int32_t> CompiledDFA::summarize(const char *data, const size_t size, const size_t budget) const
+{
+    const auto states = static_cast<int32_t>(this->size());
+
+    // the distinct states the runs are in, and for every starting state the run it belongs to
+    std::vector<int32_t> current(states);
+    std::vector<int32_t> run_of(states);
+    for (int32_t state = 0; state < states; state++)
+    {
+        current[state] = state;
+        run_of[state] = state;
+    }
+
+    std::vector<int32_t> merged_into(states, -1);
+    std::vector<int32_t> merged;
+    std::vector<int32_t> renumber;
+    // runs that end up in the same state are merged after every window, the windows grow so
+    // that merging costs O(states * log(size)) in total
+    size_t window = 64;
+    for (size_t offset = 0; offset < size; offset += window, window *= 2)
+    {
+        const size_t length = std::min(window, size - offset);
+        for (int32_t &state: current)
+        {
+            state = run(state, data + offset, length);
+        }
+
+        if (current.size() == 1)
+        {
+            continue;
+        }
+        merged.clear();
+        renumber.resize(current.size());
+        for (size_t i = 0; i < current.size(); i++)
+        {
+            int32_t &target = merged_into[current[i]];
+            if (target == -1)
+            {
+                target = static_cast<int32_t>(merged.size());
+                merged.push_back(current[i]);
+            }
+            renumber[i] = target;
+        }
+        for (const int32_t state: merged)
+        {
+            merged_into[state] = -1;
+        }
+        if (merged.size() < current.size())
+        {
+            for (int32_t &owner: run_of)
+            {
+                owner = renumber[owner];
+            }
+            current.swap(merged);
+        }
+
+        // the runs only ever merge, so this estimate of the remaining work never grows
+        const size_t remaining = size - offset - length;
+        if (remaining != 0 && current.size() > budget / remaining)
+        {
+            return {};
+        }
+    }
+
+    for (int32_t &owner: run_of)
+    {
+        owner = current[owner];
+    }
+    return run_of;
+}
+
+std::vector<uint64_t> CompiledDFA::acceptsMany(const std::string_view *strings, const size_t count) const
+{
+    return acceptsMany(strings, count, getBestKernel());
+}
+
+std::vector<uint64_t> CompiledDFA::acceptsMany(const std::string_view *strings, const size_t count,
+                                               Kernel kernel) const
+{
+    // the gather loads use 32 bit indices
+    if (kernel == Kernel::AVX2 && (getBestKernel() != Kernel::AVX2 || table.size() > INT32_MAX))
+    {
+        kernel = Kernel::SCALAR;
+    }
+
+    std::vector<uint64_t> result((count + 63) / 64, 0);
+    size_t base = kernel == Kernel::AVX2 ? acceptsManyAVX2(strings, count, result)
+                                         : acceptsManyScalar(strings, count, result);
+    for (; base < count; base++)
+    {
+        if (accepts(strings[base].data(), strings[base].size()))
+        {
+            result[base / 64] |= uint64_t(1) << (base % 64);
+        }
+    }
+    return result;
+}
+
+CompiledDFA::Kernel CompiledDFA::getBestKernel()
+{
+#ifdef AUTOMATA_AVX2_KERNEL
+    static const Kernel best = __builtin_cpu_supports("avx2") ? Kernel::AVX2 : Kernel::SCALAR;
+    return best;
+#else
+    return Kernel::SCALAR;
+#endif
+}
+
+size_t CompiledDFA::acceptsManyScalar(const std::string_view *strings, const size_t count,
+                                      std::vector<uint64_t> &result) const
+{
+    constexpr size_t LANES = 8;
+
+    const int32_t *next = table.data();
+    const uint8_t *byte_class = classes.getMap().data();
+    const size_t columns = stride;
+
+    size_t base = 0;
+    for (; base + LANES <= count; base += LANES)
+    {
+        std::array<int32_t, LANES> state{};
+        std::array<const unsigned char *, LANES> bytes{};
+        size_t shortest = strings[base].size();
+        for (size_t lane = 0; lane < LANES; lane++)
+        {
+            state[lane] = startingState;
+            bytes[lane] = reinterpret_cast<const unsigned char *>(strings[base + lane].data());
+            shortest = std::min(shortest, strings[base + lane].size());
+        }
+
+        // the common length is stepped one byte of every lane at a time, so the loads of
+        // the lanes are independent of each other and can be in flight together
+        for (size_t i = 0; i < shortest; i++)
+        {
+            for (size_t lane = 0; lane < LANES; lane++)
+            {
+                state[lane] = next[state[lane] * columns + byte_class[bytes[lane][i]]];
+            }
+        }
+
+        for (size_t lane = 0; lane < LANES; lane++)
+        {
+            const size_t input = base + lane;
+            const int32_t current = run(state[lane], strings[input].data() + shortest,
+                                        strings[input].size() - shortest);
+            if (isAccepting(current))
+            {
+                result[input / 64] |= uint64_t(1) << (input % 64);
+            }
+        }
+    }
+    return base;
+}
+
+#ifdef AUTOMATA_AVX2_KERNEL
+
+__attribute__((target("avx2")))
+size_t CompiledDFA::acceptsManyAVX2(const std::string_view *strings, const size_t count,
+                                    std::vector<uint64_t> &result) const
+{
+    constexpr size_t LANES = 16;
+
+    const auto *next = reinterpret_cast<const int *>(table.data());
+    const uint8_t *byte_class = classes.getMap().data();
+    const __m256i columns = _mm256_set1_epi32(static_cast<int>(stride));
+
+    size_t base = 0;
+    for (; base + LANES <= count; base += LANES)
+    {
+        std::array<const unsigned char *, LANES> b{};
+        size_t shortest = strings[base].size();
+        for (size_t lane = 0; lane < LANES; lane++)
+        {
+            b[lane] = reinterpret_cast<const unsigned char *>(strings[base + lane].data());
+            shortest = std::min(shortest, strings[base + lane].size());
+        }
+
+        __m256i low = _mm256_set1_epi32(startingState);
+        __m256i high = low;
+        for (size_t i = 0; i < shortest; i++)
+        {
+            const __m256i low_classes = _mm256_setr_epi32(
+                    byte_class[b[0][i]], byte_class[b[1][i]], byte_class[b[2][i]], byte_class[b[3][i]],
+                    byte_class[b[4][i]], byte_class[b[5][i]], byte_class[b[6][i]], byte_class[b[7][i]]);
+            const __m256i high_classes = _mm256_setr_epi32(
+                    byte_class[b[8][i]], byte_class[b[9][i]], byte_class[b[10][i]], byte_class[b[11][i]],
+                    byte_class[b[12][i]], byte_class[b[13][i]], byte_class[b[14][i]], byte_class[b[15][i]]);
+            low = _mm256_i32gather_epi32(next, _mm256_add_epi32(_mm256_mullo_epi32(low, columns), low_classes), 4);
+            high = _mm256_i32gather_epi32(next, _mm256_add_epi32(_mm256_mullo_epi32(high, columns), high_classes), 4);
+        }
+
+        std::array<int32_t, LANES> state{};
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(state.data()), low);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(state.data() + 8), high);
+
+        for (size_t lane = 0; lane < LANES; lane++)
+        {
+            const size_t input = base + lane;
+            const int32_t current = run(state[lane], strings[input].data() + shortest,
+                                        strings[input].size() - shortest);
+            if (isAccepting(current))
+            {
+                result[input / 64] |= uint64_t(1) << (input % 64);
+            }
+        }
+    }
+    return base;
+}
+
+#else
+
+size_t CompiledDFA::acceptsManyAVX2(const std::string_view *strings, const size_t count,
+                                    std::vector<uint64_t> &result) const
+{
+    return acceptsManyScalar(strings, count, result);
+}
+
+#endif
+
+size_t CompiledDFA::size() const
+{
+    return table.size() / stride;
+}
+
+int32_t CompiledDFA::getStartingState() const
+{
+    return startingState;
+}
+
+int32_t CompiledDFA::getDeadState() const
+{
+    return deadState;
+}
+
+int32_t CompiledDFA::getAcceptSink() const
+{
+    return acceptSink;
+}
+
+bool CompiledDFA::isDecided(const int32_t state) const
+{
+    return state == deadState || state == acceptSink;
+}
+
+int32_t CompiledDFA::getNextState(const int32_t state, const Symbol symbol) const
+{
+    return table[state * stride + classes.get(symbol)];
+}
+
+bool CompiledDFA::isAccepting(const int32_t state) const
+{
+    return (accepting[state / 64] >> (state % 64)) & 1;
+}
+
+const std::vector<int32_t> &CompiledDFA::getTable() const
+{
+    return table;
+}
+
+const ByteClasses &CompiledDFA::getByteClasses() const
+{
+    return classes;
+}
+
+size_t CompiledDFA::getStride() const
+{
+    return stride;
+}
@@ -0,0 +1,135 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#ifndef AUTOMATA_COMPILEDDFA_H
+#define AUTOMATA_COMPILEDDFA_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "FA.h"
+#include "ByteClasses.h"
+
+class DFA;
+
+// A DFA flattened into a dense transition table.
+// States are numbered 0..n-1 in the order of DFA::getStates(), state n is a
+// non-accepting dead state that absorbs every missing transition.
+// Columns are byte classes rather than bytes, so the table only grows with the
+// number of symbols the DFA can actually tell apart.
+// Transitions into states that can not reach an accepting state lead to the dead state, and
+// transitions into accepting states that can never be left for a rejecting one lead to a single
+// accept sink, so matching stops as soon as the answer is known. Bytes outside the alphabet
+// are rejected, so only automata over all 256 bytes can have an accept sink.
+class CompiledDFA
+{
+public:
+    // the implementations of acceptsMany
+    enum class Kernel : uint8_t
+    {
+        SCALAR,
+        // 16 lanes in two vectors of 8, each step is a gather load from the table
+        AVX2
+    };
+
+    explicit CompiledDFA(const DFA &dfa);
+
+    // a table that was built elsewhere, its last row must be the dead state
+    CompiledDFA(const ByteClasses &classes, std::vector<int32_t> table, std::vector<uint64_t> accepting,
+                int32_t startingState);
+
+    [[nodiscard]]
+    bool accepts(const std::string &string) const;
+
+    [[nodiscard]]
+    bool accepts(const char *data, size_t size) const;
+
+    // the state reached from `state` after reading the bytes, so input can be matched piece by piece
+    [[nodiscard]]
+    int32_t run(int32_t state, const char *data, size_t size) const;
+
+    // Splits the input into one chunk per thread. Every chunk but the first is run from all states
+    // at once to get the state each one ends in, those mappings are then applied in order.
+    // Small inputs and inputs that are short compared to the number of states are matched sequentially.
+    // A chunk whose runs do not merge (a permutation DFA runs every state to the end) is matched
+    // sequentially as well, once running it from all states would cost more than the rest of the input.
+    [[nodiscard]]
+    bool acceptsParallel(const char *data, size_t size, size_t threads) const;
+
+    // maps every state to the state it reaches after reading the bytes.
+    // Gives up and returns an empty mapping once the runs that are left would read more than `budget` bytes
+    [[nodiscard]]
+    std::vector<int32_t> summarize(const char *data, size_t size, size_t budget = SIZE_MAX) const;
+
+    // bit i of the result is set if strings[i] is accepted.
+    // The strings are matched in groups of 8 that step through the table together, so the
+    // dependent loads of one string overlap with those of the others.
+    [[nodiscard]]
+    std::vector<uint64_t> acceptsMany(const std::string_view *strings, size_t count) const;
+
+    // falls back to the scalar kernel if `kernel` can not run on this cpu or table
+    [[nodiscard]]
+    std::vector<uint64_t> acceptsMany(const std::string_view *strings, size_t count, Kernel kernel) const;
+
+    // the fastest kernel the cpu supports, checked once
+    [[nodiscard]]
+    static Kernel getBestKernel();
+
+    [[nodiscard]]
+    size_t size() const;
+
+    [[nodiscard]]
+    int32_t getStartingState() const;
+
+    [[nodiscard]]
+    int32_t getDeadState() const;
+
+    // -1 if no state accepts every continuation
+    [[nodiscard]]
+    int32_t getAcceptSink() const;
+
+    // whether the state is the dead state or the accept sink, nothing that follows changes the answer
+    [[nodiscard]]
+    bool isDecided(int32_t state) const;
+
+    [[nodiscard]]
+    int32_t getNextState(int32_t state, Symbol symbol) const;
+
+    [[nodiscard]]
+    bool isAccepting(int32_t state) const;
+
+    [[nodiscard]]
+    const std::vector<int32_t> &getTable() const;
+
+    [[nodiscard]]
+    const ByteClasses &getByteClasses() const;
+
+    // the number of columns in the table
+    [[nodiscard]]
+    size_t getStride() const;
+
+private:
+    // finds the dead and the accept sink states and redirects the transitions into them
+    void analyze();
+
+    // both match the strings in whole groups and return how many they matched
+    size_t acceptsManyScalar(const std::string_view *strings, size_t count, std::vector<uint64_t> &result) const;
+
+    size_t acceptsManyAVX2(const std::string_view *strings, size_t count, std::vector<uint64_t> &result) const;
+
+private:
+    ByteClasses classes;
+    size_t stride = 1;
+    // row-major [state][class]
+    std::vector<int32_t> table;
+    std::vector<uint64_t> accepting;
+    int32_t startingState = 0;
+    int32_t deadState = 0;
+    int32_t acceptSink = -1;
+};
+
+
+#endif //AUTOMATA_COMPILEDDFA_H
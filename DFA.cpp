@@ -2,34 +2,41 @@
 // Created by nilerrors on 2/24/24.
 //
 
+#include <algorithm>
+#include <cctype>
 #include <fstream>
 #include <iomanip>
 #include <deque>
+#include <map>
+#include <memory>
+#include <thread>
 #include <iostream>
 
 #include "DFA.h"
+#include "ByteClasses.h"
 
 
-DFA::DFA() : FA("DFA")
+DFA::DFA() : DFA(std::set<Symbol>{'0', '1'})
 {
-    json j;
-    j["type"] = "DFA";
-    j["alphabet"] = {"0", "1"};
-    j["states"] = {
-            {{"name", "s0"}, {"starting", true},  {"accepting", true}},
-            {{"name", "s1"}, {"starting", false}, {"accepting", false}},
-            {{"name", "s2"}, {"starting", false}, {"accepting", false}}
-    };
-    j["transitions"] = {
-            {{"from", "s0"}, {"to", "s0"}, {"input", "0"}},
-            {{"from", "s0"}, {"to", "s1"}, {"input", "1"}},
-            {{"from", "s1"}, {"to", "s1"}, {"input", "0"}},
-            {{"from", "s1"}, {"to", "s0"}, {"input", "1"}},
-            {{"from", "s2"}, {"to", "s1"}, {"input", "0"}},
-            {{"from", "s2"}, {"to", "s2"}, {"input", "1"}}
-    };
+    std::shared_ptr<State> s0 = newState("s0", true, true);
+    std::shared_ptr<State> s1 = newState("s1", false, false);
+    std::shared_ptr<State> s2 = newState("s2", false, false);
+    addState(s0);
+    addState(s1);
+    addState(s2);
+    addUniqueTransitions({
+            newTransition(s0, s0, '0'),
+            newTransition(s0, s1, '1'),
+            newTransition(s1, s1, '0'),
+            newTransition(s1, s0, '1'),
+            newTransition(s2, s1, '0'),
+            newTransition(s2, s2, '1')
+    });
+}
 
-    fromJSON(j);
+DFA::DFA(const std::set<Symbol> &alphabet) : FA("DFA")
+{
+    setAlphabet(alphabet);
 }
 
 [[maybe_unused]]
@@ -60,79 +67,65 @@ DFA::DFA(const DFA &first, const DFA &second, const bool isIntersection) : FA("D
         return s1->accepting && s2->accepting;
     };
 
-    std::shared_ptr<PairOfStates> startingState =
-            std::make_shared<PairOfStates>(first.getStartingState(), second.getStartingState(), true,
-                                           isAccepting(first.getStartingState(), second.getStartingState()));
+    const std::vector<std::vector<Symbol>> symbol_groups =
+            ByteClasses(ByteClasses(first), ByteClasses(second)).partition(alphabet);
 
-    std::deque<std::shared_ptr<PairOfStates>> unprocessed_states = {startingState};
-    std::set<std::shared_ptr<PairOfStates>> processed_states = {startingState};
-    std::set<std::shared_ptr<PairOfStates>> all_pairs_of_states = {startingState};
+    // the pairs only live during the construction
+    Arena scratch;
 
-    auto in_processed_states = [&processed_states](const std::shared_ptr<PairOfStates> &pair) -> bool {
-        return std::any_of(processed_states.begin(), processed_states.end(), [pair](const std::shared_ptr<PairOfStates> &state) {
-            return (state->states.first == pair->states.first && state->states.second == pair->states.second)
-                   || (state->states.first == pair->states.second && state->states.second == pair->states.first);
-        });
-    };
+    std::shared_ptr<PairOfStates> startingState =
+            Arena::make<PairOfStates>(&scratch, first.getStartingState(), second.getStartingState(), true,
+                                      isAccepting(first.getStartingState(), second.getStartingState()));
 
-    auto from_all_states = [&all_pairs_of_states](const std::shared_ptr<State> &f,
-                                                  const std::shared_ptr<State> &s) -> std::shared_ptr<PairOfStates> {
-        for (const std::shared_ptr<PairOfStates> &state: all_pairs_of_states)
-        {
-            if ((state->states.first == f && state->states.second == s)
-                || (state->states.first == s && state->states.second == f))
-            {
-                return state;
-            }
-        }
-        return nullptr;
+    // pairs are matched regardless of their order
+    auto key = [](const std::shared_ptr<State> &f, const std::shared_ptr<State> &s) {
+        return std::less<const State *>()(f.get(), s.get()) ? std::make_pair(f.get(), s.get())
+                                                            : std::make_pair(s.get(), f.get());
     };
 
+    std::map<std::pair<const State *, const State *>, std::shared_ptr<PairOfStates>> all_pairs_of_states = {
+            {key(startingState->states.first, startingState->states.second), startingState}};
+    std::deque<std::shared_ptr<PairOfStates>> unprocessed_states = {startingState};
+
+    addState(startingState->to_state(*this));
+
     while (!unprocessed_states.empty())
     {
         std::shared_ptr<PairOfStates> state = unprocessed_states.front();
         unprocessed_states.pop_front();
 
-        all_pairs_of_states.insert(state);
-        addState(state->to_state());
-
-        for (const Symbol symbol: alphabet)
+        for (const std::vector<Symbol> &group: symbol_groups)
         {
-            if (first.getNextState(state->states.first, symbol) == state->states.first &&
-                second.getNextState(state->states.second, symbol) == state->states.second)
+            // every symbol of a group leads to the same pair of states
+            std::shared_ptr<State> next_first = first.getNextState(state->states.first, group.front());
+            std::shared_ptr<State> next_second = second.getNextState(state->states.second, group.front());
+
+            if (next_first == state->states.first && next_second == state->states.second)
             {
-                addTransition(std::make_shared<Transition>(state->to_state(), state->to_state(), symbol));
+                for (const Symbol symbol: group)
+                {
+                    addTransition(newTransition(state->to_state(), state->to_state(), symbol));
+                }
                 continue;
             }
 
-            std::shared_ptr<PairOfStates> to = from_all_states(
-                    first.getNextState(state->states.first, symbol),
-                    second.getNextState(state->states.second, symbol));
+            std::shared_ptr<PairOfStates> &to = all_pairs_of_states[key(next_first, next_second)];
 
             if (to == nullptr)
             {
-                to = std::make_shared<PairOfStates>(
-                        first.getNextState(state->states.first, symbol),
-                        second.getNextState(state->states.second, symbol),
-                        isStarting(first.getNextState(state->states.first, symbol),
-                                   second.getNextState(state->states.second, symbol)),
-                        isAccepting(first.getNextState(state->states.first, symbol),
-                                    second.getNextState(state->states.second, symbol)));
+                to = Arena::make<PairOfStates>(
+                        &scratch, next_first, next_second,
+                        isStarting(next_first, next_second),
+                        isAccepting(next_first, next_second));
+                addState(to->to_state(*this));
+                unprocessed_states.push_back(to);
             }
 
-            addState(to->to_state());
-
-            if (!in_processed_states(to))
+            for (const Symbol symbol: group)
             {
-                unprocessed_states.push_back(to);
+                addTransition(newTransition(state->to_state(), to->to_state(), symbol));
             }
-
-            addTransition(
-                    std::make_shared<Transition>(
-                            state->to_state(),
-                            to->to_state(), symbol));
         }
-        processed_states.insert(state);
     }
 }
 
@@ -140,33 +133,45 @@ DFA::~DFA() = default;
 
 bool DFA::accepts(const std::string &string) const
 {
-    std::shared_ptr<State> currentState = getStartingState();
-    if (currentState == nullptr)
+    return compile()->accepts(string);
+}
+
+bool DFA::acceptsParallel(const std::string &string, size_t threads) const
+{
+    if (threads == 0)
     {
-        return false;
+        threads = std::max(1u, std::thread::hardware_concurrency());
     }
+    return compile()->acceptsParallel(string.data(), string.size(), threads);
+}
 
-    for (const Symbol c: string)
+std::vector<uint64_t> DFA::acceptsMany(const std::vector<std::string_view> &strings) const
+{
+    return compile()->acceptsMany(strings.data(), strings.size());
+}
+
+std::shared_ptr<const CompiledDFA> DFA::compile() const
+{
+    const size_t now = getRevision();
+    std::shared_ptr<const Compiled> current = std::atomic_load(&compiled);
+    if (current == nullptr || current->revision != now)
     {
-        currentState = getNextState(currentState, c);
-        if (currentState == nullptr)
-        {
-            return false;
-        }
+        // readers that race here build the same table, whichever is stored last wins
+        current = std::make_shared<const Compiled>(Compiled{now, CompiledDFA(*this)});
+        std::atomic_store(&compiled, current);
     }
-    return currentState->accepting;
+    return {current, &current->table};
 }
 
 DFA DFA::minimize() const
 {
-    DFA min;
-    min.clear();
-    min.alphabet = alphabet;
+    DFA min(alphabet);
     min.minimized = true;
     min.table = std::make_shared<StatesTable>();
     min.table->from(this);
     min.table->fill();
 
+    Arena scratch;
     std::vector<std::shared_ptr<SetOfStates>> merged_states;
 
     auto in_merged_states = [&](const std::shared_ptr<State> &state) -> std::pair<bool, std::shared_ptr<SetOfStates>> {
@@ -194,7 +199,9 @@ DFA DFA::minimize() const
 
         if (!first_in_merged.first && !second_in_merged.first)
         {
-            merged_states.push_back(std::make_shared<SetOfStates>(std::set({eqv.first, eqv.second})));
+            merged_states.push_back(Arena::make<SetOfStates>(&scratch, false, &scratch));
+            merged_states.back()->add(eqv.first);
+            merged_states.back()->add(eqv.second);
             merged_states.back()->isStarting = eqv.first->starting || eqv.second->starting;
         }
         else if (first_in_merged.first)
@@ -220,14 +227,15 @@ DFA DFA::minimize() const
         std::pair<bool, std::shared_ptr<SetOfStates>> state_in_merged = in_merged_states(state);
         if (!state_in_merged.first)
         {
-            merged_states.push_back(std::make_shared<SetOfStates>(std::set({state})));
+            merged_states.push_back(Arena::make<SetOfStates>(&scratch, false, &scratch));
+            merged_states.back()->add(state);
             merged_states.back()->isStarting = state->starting;
         }
     }
 
     for (const std::shared_ptr<SetOfStates> &ms: merged_states)
     {
-        min.addState(ms->to_state());
+        min.addState(ms->to_state(min));
         if (ms->to_state()->starting)
         {
             min.startingState = ms->to_state();
@@ -244,13 +252,200 @@ DFA DFA::minimize() const
             continue;
         }
 
-        min.addTransition(std::make_shared<Transition>(
+        min.addTransition(min.newTransition(
                 from_in_merged.second->to_state(), to_in_merged.second->to_state(), transition->symbol));
     }
 
     return min;
 }
 
+namespace
+{
+    // a byte as a C++ literal, printable ones are written as characters
+    std::string cpp_byte(const unsigned char byte)
+    {
+        if (std::isalnum(byte) || (std::ispunct(byte) && byte != '\'' && byte != '\\'))
+        {
+            return std::string("'") + static_cast<char>(byte) + "'";
+        }
+        return std::to_string(byte);
+    }
+
+    // the smallest unsigned integer type that holds `value`
+    std::string cpp_uint(const size_t value)
+    {
+        if (value <= UINT8_MAX)
+        {
+            return "std::uint8_t";
+        }
+        if (value <= UINT16_MAX)
+        {
+            return "std::uint16_t";
+        }
+        return "std::uint32_t";
+    }
+}
+
+std::string DFA::to_cpp(const std::string &function, const CppStyle style) const
+{
+    const std::shared_ptr<const CompiledDFA> dfa = compile();
+    const std::vector<int32_t> &table = dfa->getTable();
+    const size_t stride = dfa->getStride();
+    const int32_t dead = dfa->getDeadState();
+    const int32_t sink = dfa->getAcceptSink();
+
+    // only the states that can be reached are generated, numbered in breadth first order from the start
+    std::vector<int32_t> number(dfa->size(), -1);
+    std::vector<int32_t> states;
+    auto visit = [&](const int32_t state) {
+        if (state != dead && number[state] == -1)
+        {
+            number[state] = static_cast<int32_t>(states.size());
+            states.push_back(state);
+        }
+    };
+    visit(dfa->getStartingState());
+    for (size_t i = 0; i < states.size(); i++)
+    {
+        for (size_t byte_class = 0; byte_class < stride; byte_class++)
+        {
+            visit(table[states[i] * stride + byte_class]);
+        }
+    }
+    number[dead] = static_cast<int32_t>(states.size());
+
+    std::string result = "// generated from a " + std::to_string(getStates().size()) + " state DFA by DFA::to_cpp\n";
+    result += "#pragma once\n\n#include <cstddef>\n#include <cstdint>\n\n";
+    result += "inline bool " + function + "(const char *data, std::size_t size)\n{\n";
+
+    if (style == CppStyle::TABLE)
+    {
+        const std::string state_type = cpp_uint(states.size());
+        const std::array<uint8_t, 256> &classes = dfa->getByteClasses().getMap();
+        result += "    static constexpr std::uint8_t classes[256] = {";
+        for (size_t byte = 0; byte < 256; byte++)
+        {
+            result += std::string(byte % 16 == 0 ? "\n        " : " ") + std::to_string(classes[byte]) + ",";
+        }
+        result += "\n    };\n";
+        result += "    static constexpr " + state_type + " table[" + std::to_string(states.size() + 1) + "]["
+                  + std::to_string(stride) + "] = {\n";
+        for (size_t i = 0; i <= states.size(); i++)
+        {
+            result += "        {";
+            for (size_t byte_class = 0; byte_class < stride; byte_class++)
+            {
+                const int32_t to = i == states.size() ? dead : table[states[i] * stride + byte_class];
+                result += (byte_class == 0 ? "" : ", ") + std::to_string(number[to]);
+            }
+            result += "},\n";
+        }
+        result += "    };\n";
+        result += "    static constexpr bool accepting[" + std::to_string(states.size() + 1) + "] = {";
+        for (size_t i = 0; i <= states.size(); i++)
+        {
+            result += std::string(i == 0 ? "" : ", ") + (i < states.size() && dfa->isAccepting(states[i]) ? "true" : "false");
+        }
+        result += "};\n\n";
+
+        result += "    " + state_type + " state = " + std::to_string(number[dfa->getStartingState()]) + ";\n";
+        result += "    for (std::size_t i = 0; i < size; i++)\n    {\n";
+        result += "        state = table[state][classes[static_cast<unsigned char>(data[i])]];\n";
+        result += "        if (state == " + std::to_string(states.size()) + ")\n        {\n";
+        result += "            return false;\n        }\n";
+        if (sink != -1 && number[sink] != -1)
+        {
+            result += "        if (state == " + std::to_string(number[sink]) + ")\n        {\n";
+            result += "            return true;\n        }\n";
+        }
+        result += "    }\n    return accepting[state];\n}\n";
+        return result;
+    }
+
+    // where a transition leads, the dead state and the accept sink end the match right away
+    auto jump = [&](const int32_t to) -> std::string {
+        if (to == dead)
+        {
+            return "return false;";
+        }
+        if (to == sink)
+        {
+            return "return true;";
+        }
+        return "goto s" + std::to_string(number[to]) + ";";
+    };
+
+    std::vector<bool> labeled(states.size(), false);
+    for (const int32_t state: states)
+    {
+        for (size_t byte_class = 0; byte_class < stride; byte_class++)
+        {
+            const int32_t to = table[state * stride + byte_class];
+            if (to != dead && to != sink)
+            {
+                labeled[number[to]] = true;
+            }
+        }
+    }
+
+    result += "    const char *end = data + size;\n";
+    if (states.empty() || states.front() == sink)
+    {
+        result += "    return " + std::string(states.empty() ? "false" : "true") + ";\n}\n";
+        return result;
+    }
+    for (size_t i = 0; i < states.size(); i++)
+    {
+        const int32_t state = states[i];
+        if (state == sink)
+        {
+            continue;
+        }
+        if (labeled[i])
+        {
+            result += "s" + std::to_string(i) + ":\n";
+        }
+        result += "    if (data == end)\n    {\n";
+        result += std::string("        return ") + (dfa->isAccepting(state) ? "true" : "false") + ";\n    }\n";
+
+        // the bytes are grouped by where they lead, the largest group becomes the default
+        std::map<int32_t, std::vector<unsigned char>> targets;
+        for (size_t byte = 0; byte < 256; byte++)
+        {
+            const auto symbol = static_cast<unsigned char>(byte);
+            targets[table[state * stride + dfa->getByteClasses().get(static_cast<Symbol>(symbol))]].push_back(symbol);
+        }
+        const auto fallback = std::max_element(targets.begin(), targets.end(), [](const auto &a, const auto &b) {
+            return a.second.size() < b.second.size();
+        });
+
+        result += "    switch (static_cast<unsigned char>(*data++))\n    {\n";
+        for (const auto &[to, bytes]: targets)
+        {
+            if (to == fallback->first)
+            {
+                continue;
+            }
+            for (size_t b = 0; b < bytes.size(); b++)
+            {
+                result += std::string(b % 8 == 0 ? "    " : " ") + "case " + cpp_byte(bytes[b]) + ":";
+                result += b % 8 == 7 || b + 1 == bytes.size() ? "\n" : "";
+            }
+            result += "        " + jump(to) + "\n";
+        }
+        result += "    default:\n        " + jump(fallback->first) + "\n    }\n";
+    }
+    result += "}\n";
+    return result;
+}
+
+void DFA::to_cpp(const std::string &file, const std::string &function, const CppStyle style) const
+{
+    std::ofstream output_file(file);
+    output_file << to_cpp(function, style);
+    output_file.close();
+}
+
 void DFA::printTable() const
 {
     if (!minimized || table == nullptr)
@@ -264,15 +459,12 @@ void DFA::printTable() const
 std::shared_ptr<Transition>
 DFA::getTransitionFromStateBySymbol(const std::shared_ptr<State> &state, Symbol symbol) const
 {
-    for (const std::shared_ptr<Transition> &transition: getTransitionsFromState(state))
+    const TransitionList &bySymbol = getTransitionsFromState(state, symbol);
+    if (bySymbol.empty())
     {
-        if (transition->symbol == symbol)
-        {
-            return transition;
-        }
+        return nullptr;
     }
-
-    return nullptr;
+    return bySymbol.front();
 }
 
 bool operator==(const DFA &a, const DFA &b)
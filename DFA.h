@@ -9,24 +9,59 @@
 #include "json.hpp"
 
 #include "FA.h"
+#include "CompiledDFA.h"
 #include "StatesTable.h"
 
 
 class DFA : public FA
 {
 public:
+    // the shape of the matcher that to_cpp generates
+    enum class CppStyle : uint8_t
+    {
+        // a static constexpr transition table and a loop over the input
+        TABLE,
+        // one label per state, the next state is chosen by a switch and reached with goto
+        SWITCH
+    };
+
+    // a small sample automaton over {0, 1}
     DFA();
 
+    // an empty automaton, the starting point of every construction
+    explicit DFA(const std::set<Symbol> &alphabet);
+
     [[maybe_unused]]
     explicit DFA(const std::string &file_path);
 
     explicit DFA(const DFA &first, const DFA &second, bool isIntersection);
 
+    DFA(const DFA &other) = default;
+
+    DFA(DFA &&other) noexcept = default;
+
     ~DFA() override;
 
+    DFA &operator=(const DFA &other) = default;
+
+    DFA &operator=(DFA &&other) noexcept = default;
+
     [[nodiscard]]
     bool accepts(const std::string &string) const override;
 
+    // matches one long input on several threads, 0 uses every core, see CompiledDFA::acceptsParallel
+    [[nodiscard]]
+    bool acceptsParallel(const std::string &string, size_t threads = 0) const;
+
+    // bit i of the result is set if strings[i] is accepted, see CompiledDFA::acceptsMany
+    [[nodiscard]]
+    std::vector<uint64_t> acceptsMany(const std::vector<std::string_view> &strings) const;
+
+    // the dense table form of this DFA, rebuilt only after a mutation.
+    // concurrent calls on an unchanged DFA are safe, the table is published with an atomic swap
+    [[nodiscard]]
+    std::shared_ptr<const CompiledDFA> compile() const;
+
     [[nodiscard]]
     std::shared_ptr<Transition>
     getTransitionFromStateBySymbol(const std::shared_ptr<State> &state, Symbol symbol) const;
@@ -34,11 +69,27 @@ public:
     [[nodiscard]]
     DFA minimize() const;
 
+    // standalone C++ source of `bool function(const char *data, std::size_t size)`,
+    // it only needs <cstddef> and <cstdint> and matches exactly what this DFA accepts
+    [[nodiscard]]
+    std::string to_cpp(const std::string &function = "accepts", CppStyle style = CppStyle::TABLE) const;
+
+    void to_cpp(const std::string &file, const std::string &function, CppStyle style) const;
+
     void printTable() const;
 
 private:
     bool minimized = false;
     std::shared_ptr<StatesTable> table = nullptr;
+
+    // the table together with the revision it was built from, only accessed with std::atomic_load/store
+    struct Compiled
+    {
+        size_t revision;
+        CompiledDFA table;
+    };
+
+    mutable std::shared_ptr<const Compiled> compiled = nullptr;
 };
 
 bool operator==(const DFA &a, const DFA &b);
@@ -2,6 +2,8 @@
 // Created by nilerrors on 3/12/24.
 //
 
+#include <unordered_map>
+
 #include "ENFA.h"
 
 ENFA::ENFA()
@@ -17,27 +19,22 @@ ENFA::ENFA(const std::string &file_path)
     fromPath(file_path);
 }
 
-ENFA::~ENFA()
-{
-    clear();
-}
+ENFA::~ENFA() = default;
 
 void ENFA::optimizeStart()
 {
-    std::vector<std::shared_ptr<Transition>> transitionsFromStarting = getTransitionsFromState(getStartingState());
+    TransitionList transitionsFromStarting = getTransitionsFromState(getStartingState());
     if (transitionsFromStarting.size() == 1 && transitionsFromStarting.front()->symbol == epsilon)
     {
+        std::shared_ptr<State> oldStarting = getStartingState();
         std::shared_ptr<State> newStarting = transitionsFromStarting.front()->to;
-        newStarting->starting = true;
-        for (std::shared_ptr<Transition> &transition: getTransitionsToState(getStartingState()))
+        setStarting(newStarting, true);
+        for (const std::shared_ptr<Transition> &transition: std::vector(getTransitionsToState(oldStarting)))
         {
-            transition->to = newStarting;
+            moveTransition(transition, transition->from, newStarting);
         }
-        transitions.erase(std::remove(
-                transitions.begin(),
-                transitions.end(),
-                transitionsFromStarting.front()), transitions.end());
-        states.erase(std::remove(states.begin(), states.end(), getStartingState()), states.end());
+        removeTransition(transitionsFromStarting.front());
+        removeState(oldStarting);
         startingState = newStarting;
     }
 
@@ -52,16 +49,13 @@ void ENFA::optimizeAccept()
         if (transitionsToAccepting.size() == 1 && transitionsToAccepting.front()->symbol == epsilon)
         {
             std::shared_ptr<State> newAccept = transitionsToAccepting.front()->from;
-            newAccept->accepting = true;
-            for (std::shared_ptr<Transition> &transition: getTransitionsFromState(acceptingState))
+            setAccepting(newAccept, true);
+            for (const std::shared_ptr<Transition> &transition: std::vector(getTransitionsFromState(acceptingState)))
             {
-                transition->from = newAccept;
+                moveTransition(transition, newAccept, transition->to);
             }
-            transitions.erase(std::remove(
-                    transitions.begin(),
-                    transitions.end(),
-                    transitionsToAccepting.front()), transitions.end());
-            states.erase(std::remove(states.begin(), states.end(), acceptingState), states.end());
+            removeTransition(transitionsToAccepting.front());
+            removeState(acceptingState);
         }
     }
 }
@@ -79,51 +73,57 @@ void ENFA::join(std::shared_ptr<ENFA> &result, const std::shared_ptr<ENFA> &firs
                    second->alphabet.cbegin(), second->alphabet.cend(),
                    std::inserter(result->alphabet, result->alphabet.begin()));
 
-    std::shared_ptr<State> start = std::make_shared<State>("start", true, false);
-    std::shared_ptr<State> end = std::make_shared<State>("end", false, true);
+    std::shared_ptr<State> start = result->newState("start", true, false);
+    std::shared_ptr<State> end = result->newState("end", false, true);
 
     result->addState(start);
     result->addState(end);
 
+    // the copies are only named if the result is ever exported or searched by name
+    std::unordered_map<const State *, std::shared_ptr<State>> first_copies;
+    std::unordered_map<const State *, std::shared_ptr<State>> second_copies;
+
     for (const std::shared_ptr<State> &state: first->states)
     {
-        std::shared_ptr<State> new_state = std::make_shared<State>("j1" + state->name, false, false);
+        std::shared_ptr<State> new_state = result->newState("j1", state, false, false);
+        first_copies.emplace(state.get(), new_state);
         result->addState(new_state);
         if (state->starting)
         {
-            result->addTransition(std::make_shared<Transition>(start, new_state, result->epsilon));
+            result->addTransition(result->newTransition(start, new_state, result->epsilon));
         }
         if (state->accepting)
         {
-            result->addTransition(std::make_shared<Transition>(new_state, end, result->epsilon));
+            result->addTransition(result->newTransition(new_state, end, result->epsilon));
         }
     }
     for (const std::shared_ptr<State> &state: second->states)
     {
-        std::shared_ptr<State> new_state = std::make_shared<State>("j2" + state->name, false, false);
+        std::shared_ptr<State> new_state = result->newState("j2", state, false, false);
+        second_copies.emplace(state.get(), new_state);
         result->addState(new_state);
         if (state->starting)
         {
-            result->addTransition(std::make_shared<Transition>(start, new_state, result->epsilon));
+            result->addTransition(result->newTransition(start, new_state, result->epsilon));
         }
         if (state->accepting)
         {
-            result->addTransition(std::make_shared<Transition>(new_state, end, result->epsilon));
+            result->addTransition(result->newTransition(new_state, end, result->epsilon));
         }
     }
 
     for (const std::shared_ptr<Transition> &transition: first->transitions)
     {
-        result->addTransition(std::make_shared<Transition>(
-                result->getState("j1" + transition->from->name),
-                result->getState("j1" + transition->to->name),
+        result->addTransition(result->newTransition(
+                first_copies[transition->from.get()],
+                first_copies[transition->to.get()],
                 transition->symbol));
     }
     for (const std::shared_ptr<Transition> &transition: second->transitions)
     {
-        result->addTransition(std::make_shared<Transition>(
-                result->getState("j2" + transition->from->name),
-                result->getState("j2" + transition->to->name),
+        result->addTransition(result->newTransition(
+                second_copies[transition->from.get()],
+                second_copies[transition->to.get()],
                 transition->symbol));
     }
 }
@@ -140,17 +140,21 @@ void ENFA::link(std::shared_ptr<ENFA> &result, const std::shared_ptr<ENFA> &firs
                    second->alphabet.cbegin(), second->alphabet.cend(),
                    std::inserter(result->alphabet, result->alphabet.begin()));
 
-    std::shared_ptr<State> end = std::make_shared<State>("end", false, true);
+    std::shared_ptr<State> end = result->newState("end", false, true);
 
     result->addState(end);
 
+    std::unordered_map<const State *, std::shared_ptr<State>> first_copies;
+    std::unordered_map<const State *, std::shared_ptr<State>> second_copies;
+
     for (const std::shared_ptr<State> &state: first->states)
     {
         if (state == nullptr)
         {
             continue;
         }
-        std::shared_ptr<State> new_state = std::make_shared<State>("l1" + state->name, state->starting, false);
+        std::shared_ptr<State> new_state = result->newState("l1", state, state->starting, false);
+        first_copies.emplace(state.get(), new_state);
         result->addState(new_state);
     }
     for (const std::shared_ptr<State> &state: second->states)
@@ -159,33 +163,35 @@ void ENFA::link(std::shared_ptr<ENFA> &result, const std::shared_ptr<ENFA> &firs
         {
             continue;
         }
-        std::shared_ptr<State> new_state = std::make_shared<State>("l2" + state->name, false, false);
+        std::shared_ptr<State> new_state = result->newState("l2", state, false, false);
+        second_copies.emplace(state.get(), new_state);
         result->addState(new_state);
         if (state->accepting)
         {
-            result->addTransition(std::make_shared<Transition>(new_state, end, result->epsilon));
+            result->addTransition(result->newTransition(new_state, end, result->epsilon));
         }
     }
 
+    const std::shared_ptr<State> &second_start = second_copies[second->getStartingState().get()];
     for (const std::shared_ptr<Transition> &transition: first->transitions)
     {
-        result->addTransition(std::make_shared<Transition>(
-                result->getState("l1" + transition->from->name),
-                result->getState("l1" + transition->to->name),
+        result->addTransition(result->newTransition(
+                first_copies[transition->from.get()],
+                first_copies[transition->to.get()],
                 transition->symbol));
         if (transition->to->accepting)
         {
-            result->addTransition(std::make_shared<Transition>(
-                    result->getState("l1" + transition->to->name),
-                    result->getState("l2" + second->getStartingState()->name),
+            result->addTransition(result->newTransition(
+                    first_copies[transition->to.get()],
+                    second_start,
                     result->epsilon));
         }
     }
     for (const std::shared_ptr<Transition> &transition: second->transitions)
     {
-        result->addTransition(std::make_shared<Transition>(
-                result->getState("l2" + transition->from->name),
-                result->getState("l2" + transition->to->name),
+        result->addTransition(result->newTransition(
+                second_copies[transition->from.get()],
+                second_copies[transition->to.get()],
                 transition->symbol));
     }
 }
@@ -195,25 +201,28 @@ void ENFA::star(std::shared_ptr<ENFA> &result, const std::shared_ptr<ENFA> &enfa
     result->setEpsilon(enfa->epsilon);
     result->setAlphabet(enfa->getAlphabet());
 
-    std::shared_ptr<State> start = std::make_shared<State>("start", true, false);
-    std::shared_ptr<State> end = std::make_shared<State>("end", false, true);
+    std::shared_ptr<State> start = result->newState("start", true, false);
+    std::shared_ptr<State> end = result->newState("end", false, true);
 
     result->addState(start);
     result->addState(end);
 
-    result->addTransition(std::make_shared<Transition>(start, end, result->epsilon));
+    result->addTransition(result->newTransition(start, end, result->epsilon));
+
+    std::unordered_map<const State *, std::shared_ptr<State>> copies;
 
     for (const std::shared_ptr<State> &state: enfa->getStates())
     {
-        std::shared_ptr<State> new_state = std::make_shared<State>("s" + state->name, false, false);
+        std::shared_ptr<State> new_state = result->newState("s", state, false, false);
+        copies.emplace(state.get(), new_state);
         result->addState(new_state);
         if (state->starting)
         {
-            result->addTransition(std::make_shared<Transition>(start, new_state, result->epsilon));
+            result->addTransition(result->newTransition(start, new_state, result->epsilon));
         }
         if (state->accepting)
         {
-            result->addTransition(std::make_shared<Transition>(new_state, end, result->epsilon));
+            result->addTransition(result->newTransition(new_state, end, result->epsilon));
         }
     }
 
@@ -221,8 +230,8 @@ void ENFA::star(std::shared_ptr<ENFA> &result, const std::shared_ptr<ENFA> &enfa
     {
         if (state->accepting)
         {
-            result->addTransition(std::make_shared<Transition>(
-                    result->getState("s" + state->name),
+            result->addTransition(result->newTransition(
+                    copies[state.get()],
                     result->getStartingState(),
                     result->epsilon));
         }
@@ -230,9 +239,9 @@ void ENFA::star(std::shared_ptr<ENFA> &result, const std::shared_ptr<ENFA> &enfa
 
     for (const std::shared_ptr<Transition> &transition: enfa->getTransitions())
     {
-        result->addTransition(std::make_shared<Transition>(
-                result->getState("s" + transition->from->name),
-                result->getState("s" + transition->to->name),
+        result->addTransition(result->newTransition(
+                copies[transition->from.get()],
+                copies[transition->to.get()],
                 transition->symbol));
     }
 }
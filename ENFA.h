@@ -15,8 +15,16 @@ public:
 
     explicit ENFA(const std::string &file_path);
 
+    ENFA(const ENFA &other) = default;
+
+    ENFA(ENFA &&other) noexcept = default;
+
     virtual ~ENFA();
 
+    ENFA &operator=(const ENFA &other) = default;
+
+    ENFA &operator=(ENFA &&other) noexcept = default;
+
     void optimizeStart();
 
     void optimizeAccept();
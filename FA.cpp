@@ -7,9 +7,16 @@
 #include <iostream>
 #include <iomanip>
 
+namespace
+{
+    const TransitionList NO_TRANSITIONS;
+}
+
 FA::FA(const std::string &type)
 {
     FA::type = type;
+    // states point into the names, a state that outlives the automaton keeps the arena and so the names
+    arena->keep(names);
 }
 
 FA::~FA() = default;
@@ -23,6 +30,23 @@ void FA::clear()
     alphabet.clear();
     states.clear();
     transitions.clear();
+    // the arena and the names are kept, states made before the clear may still be held, the memory of
+    // the released ones is reused
+    if (arena == nullptr || names == nullptr || revision == nullptr)
+    {
+        arena = Arena::create();
+        names = std::make_shared<StateNames>();
+        arena->keep(names);
+        revision = std::make_shared<std::atomic<size_t>>(0);
+    }
+    // the indexes of a moved from automaton still point to the arena it lost
+    outgoing = TransitionIndex(TransitionIndex::allocator_type(arena.get()));
+    incoming = TransitionIndex(TransitionIndex::allocator_type(arena.get()));
+    stateIds = StateIndex(StateIndex::allocator_type(arena.get()));
+    stateIdsComplete = true;
+    transitionKeys = TransitionKeys(TransitionKeys::allocator_type(arena.get()));
+    transitionKeysStale = false;
+    (*revision)++;
 }
 
 void FA::fromPath(const std::string &file_path)
@@ -77,6 +101,61 @@ void FA::fromJSON(const json &j)
     validateTransitionsAndStore(j["transitions"]);
 }
 
+std::shared_ptr<State> FA::newState(std::string name, const bool starting, const bool accepting) const
+{
+    return Arena::make<State>(arena.get(), names.get(), names->add(std::move(name)), starting, accepting);
+}
+
+std::shared_ptr<Transition>
+FA::newTransition(const std::shared_ptr<State> &from, const std::shared_ptr<State> &to, const Symbol symbol) const
+{
+    return Arena::make<Transition>(arena.get(), from, to, symbol);
+}
+
+std::shared_ptr<State> FA::newState(std::string prefix, const std::shared_ptr<State> &source, const bool starting,
+                                    const bool accepting) const
+{
+    return Arena::make<State>(arena.get(), names.get(),
+                              names->add(Naming::PREFIXED, {source->asPart()}, std::move(prefix)),
+                              starting, accepting);
+}
+
+std::shared_ptr<State> FA::newState(const Naming naming, std::vector<StateNames::Part> parts, const bool starting,
+                                    const bool accepting) const
+{
+    return Arena::make<State>(arena.get(), names.get(), names->add(naming, std::move(parts)), starting, accepting);
+}
+
+std::shared_ptr<State> SetOfStates::to_state(const FA &fa)
+{
+    if (state == nullptr)
+    {
+        std::vector<StateNames::Part> parts;
+        parts.reserve(states.size());
+        for (const std::shared_ptr<State> &s: states)
+        {
+            parts.push_back(s->asPart());
+        }
+        state = fa.newState(Naming::SET, std::move(parts), isStarting, isAccepting());
+    }
+    return state;
+}
+
+std::shared_ptr<State> PairOfStates::to_state(const FA &fa)
+{
+    if (state == nullptr)
+    {
+        state = fa.newState(Naming::PAIR, {states.first->asPart(), states.second->asPart()}, isStarting,
+                            isAccepting);
+    }
+    return state;
+}
+
+const std::shared_ptr<Arena> &FA::getArena() const
+{
+    return arena;
+}
+
 void FA::addState(const std::shared_ptr<State> &state)
 {
     if (state->starting)
@@ -86,15 +165,22 @@ void FA::addState(const std::shared_ptr<State> &state)
             throw std::runtime_error("cannot have multiple instances of starting states");
         }
         startingState = state;
+        (*revision)++;
     }
-    for (const std::shared_ptr<State> &s: states)
+    if (state->isNamed())
     {
-        if (s->name == state->name)
+        if (!stateIds.emplace(state->getName(), states.size()).second)
         {
             return;
         }
     }
+    else
+    {
+        // derived states are unique by construction, naming them is deferred to the first lookup
+        stateIdsComplete = false;
+    }
     states.push_back(state);
+    (*revision)++;
 }
 
 void FA::addTransition(const std::shared_ptr<Transition> &transition)
@@ -103,16 +189,131 @@ void FA::addTransition(const std::shared_ptr<Transition> &transition)
     {
         return;
     }
-    for (const std::shared_ptr<Transition> &t: transitions)
+    // transitions refer to the stored state of the same name, so that duplicates are detected by identity
+    if (std::shared_ptr<State> from = findIndexedState(*transition->from); from != nullptr)
+    {
+        transition->from = from;
+    }
+    if (std::shared_ptr<State> to = findIndexedState(*transition->to); to != nullptr)
     {
-        if (t->from->name == transition->from->name
-            && t->to->name == transition->to->name
-            && t->symbol == transition->symbol)
+        transition->to = to;
+    }
+    if (transitionKeysStale)
+    {
+        transitionKeys.clear();
+        for (const std::shared_ptr<Transition> &t: transitions)
         {
-            return;
+            transitionKeys.insert({t->from.get(), t->to.get(), t->symbol});
         }
+        transitionKeysStale = false;
+    }
+    if (!transitionKeys.insert({transition->from.get(), transition->to.get(), transition->symbol}).second)
+    {
+        return;
+    }
+    indexTransition(transition);
+}
+
+void FA::addUniqueTransitions(const std::vector<std::shared_ptr<Transition>> &new_transitions)
+{
+    transitions.reserve(transitions.size() + new_transitions.size());
+    for (const std::shared_ptr<Transition> &transition: new_transitions)
+    {
+        indexTransition(transition);
+    }
+    transitionKeysStale = true;
+}
+
+std::shared_ptr<State> FA::findIndexedState(const State &state) const
+{
+    if (!state.isNamed())
+    {
+        return nullptr;
+    }
+    auto found = stateIds.find(state.getName());
+    if (found == stateIds.end())
+    {
+        return nullptr;
     }
+    return states[found->second];
+}
+
+void FA::indexTransition(const std::shared_ptr<Transition> &transition)
+{
     transitions.push_back(transition);
+    transitionsOf(outgoing, transition->from.get()).add(transition);
+    transitionsOf(incoming, transition->to.get()).add(transition);
+    (*revision)++;
+}
+
+StateTransitions &FA::transitionsOf(TransitionIndex &index, const State *state)
+{
+    return index.try_emplace(state, index.get_allocator().arena).first->second;
+}
+
+void FA::removeState(const std::shared_ptr<State> &state)
+{
+    size_t id = states.size();
+    StateIndex::iterator found = stateIds.end();
+    if (state->isNamed())
+    {
+        found = stateIds.find(state->getName());
+        if (found != stateIds.end() && states[found->second] == state)
+        {
+            id = found->second;
+        }
+    }
+    if (id == states.size())
+    {
+        // derived states that were never looked up by name are not indexed
+        id = std::find(states.begin(), states.end(), state) - states.begin();
+    }
+    if (id != states.size())
+    {
+        if (found != stateIds.end() && found->second == id)
+        {
+            stateIds.erase(found);
+        }
+        if (id != states.size() - 1)
+        {
+            states[id] = std::move(states.back());
+            if (states[id]->isNamed())
+            {
+                auto moved = stateIds.find(states[id]->getName());
+                if (moved != stateIds.end() && moved->second == states.size() - 1)
+                {
+                    moved->second = id;
+                }
+            }
+        }
+        states.pop_back();
+    }
+    outgoing.erase(state.get());
+    incoming.erase(state.get());
+    (*revision)++;
+}
+
+void FA::removeTransition(const std::shared_ptr<Transition> &transition)
+{
+    transitionKeys.erase({transition->from.get(), transition->to.get(), transition->symbol});
+    transitions.erase(std::remove(transitions.begin(), transitions.end(), transition), transitions.end());
+    transitionsOf(outgoing, transition->from.get()).remove(transition);
+    transitionsOf(incoming, transition->to.get()).remove(transition);
+    (*revision)++;
+}
+
+void FA::moveTransition(const std::shared_ptr<Transition> &transition,
+                        const std::shared_ptr<State> &from, const std::shared_ptr<State> &to)
+{
+    transitionKeys.erase({transition->from.get(), transition->to.get(), transition->symbol});
+    transitionsOf(outgoing, transition->from.get()).remove(transition);
+    transitionsOf(incoming, transition->to.get()).remove(transition);
+    transition->from = from;
+    transition->to = to;
+    transitionKeys.insert({from.get(), to.get(), transition->symbol});
+    transitionsOf(outgoing, from.get()).add(transition);
+    transitionsOf(incoming, to.get()).add(transition);
+    (*revision)++;
 }
 
 json FA::to_json() const
@@ -156,15 +357,15 @@ std::string FA::to_dot() const
     result += "  rankdir=LR;\n";
     for (const std::shared_ptr<State> &state: states)
     {
-        result += "  \"" + state->name + "\" [shape=" + (state->accepting ? "doublecircle" : "circle") + "];\n";
+        result += "  \"" + state->getName() + "\" [shape=" + (state->accepting ? "doublecircle" : "circle") + "];\n";
         if (state->starting)
         {
-            result += "  start -> \"" + state->name + "\";\n";
+            result += "  start -> \"" + state->getName() + "\";\n";
         }
     }
     for (const std::shared_ptr<Transition> &transition: transitions)
     {
-        result += "  \"" + transition->from->name + "\" -> \"" + transition->to->name
+        result += "  \"" + transition->from->getName() + "\" -> \"" + transition->to->getName()
                   + "\" [label=\"" + transition->symbol + "\"];\n";
     }
     result += "}\n";
@@ -189,10 +390,7 @@ std::string FA::to_stats() const
     std::map<uint, uint> degrees;
     for (const std::shared_ptr<State> &state: states)
     {
-        uint degree = std::count_if(transitions.begin(), transitions.end(),
-                                    [state](const std::shared_ptr<Transition> &transition) {
-                                        return transition->from == state;
-                                    });
+        uint degree = getTransitionsFromState(state).size();
         if (degrees.find(degree) == degrees.end())
         {
             degrees[degree] = 0;
@@ -287,8 +485,8 @@ void FA::validateStatesAndStore(const nlohmann::json &states_array)
             throw std::runtime_error("state accepting attribute must be of type boolean");
         }
 
-        std::shared_ptr<State> new_state = std::make_shared<State>(
-                state["name"].get<std::string>(),
+        std::shared_ptr<State> new_state = newState(
+                state["name"].get_ref<const std::string &>(),
                 state["starting"].get<bool>(),
                 state["accepting"].get<bool>());
         addState(new_state);
@@ -316,7 +514,8 @@ void FA::validateTransitionsAndStore(const nlohmann::json &transitions_array)
         {
             throw std::runtime_error("transition from must be of type string");
         }
-        if (getState(transition["from"].get<std::string>()) == nullptr)
+        std::shared_ptr<State> from = getState(transition["from"].get_ref<const std::string &>());
+        if (from == nullptr)
         {
             throw std::runtime_error("transition from attribute must be part of states");
         }
@@ -328,7 +527,8 @@ void FA::validateTransitionsAndStore(const nlohmann::json &transitions_array)
         {
             throw std::runtime_error("transition to attribute must be of type string");
         }
-        if (getState(transition["to"].get<std::string>()) == nullptr)
+        std::shared_ptr<State> to = getState(transition["to"].get_ref<const std::string &>());
+        if (to == nullptr)
         {
             throw std::runtime_error("transition to attribute must be part of states");
         }
@@ -344,10 +544,10 @@ void FA::validateTransitionsAndStore(const nlohmann::json &transitions_array)
         {
             throw std::runtime_error("transition input attribute must be of size 1");
         }
-        if (std::find(alphabet.cbegin(), alphabet.cend(),
-                      transition["input"].get<std::string>().front()) == alphabet.cend())
+        const Symbol symbol = transition["input"].get_ref<const std::string &>().front();
+        if (alphabet.count(symbol) == 0)
         {
-            if (allowEpsilonTransitions && transition["input"].get<std::string>().front() != epsilon)
+            if (allowEpsilonTransitions && symbol != epsilon)
             {
                 throw std::runtime_error(
                         "transition input attribute must be part of alphabet, got: "
@@ -355,11 +555,7 @@ void FA::validateTransitionsAndStore(const nlohmann::json &transitions_array)
             }
         }
 
-        addTransition(
-                std::make_shared<Transition>(
-                        getState(transition["from"].get<std::string>()),
-                        getState(transition["to"].get<std::string>()),
-                        transition["input"].get<std::string>().front()));
+        addTransition(newTransition(from, to, symbol));
     }
 }
 
@@ -369,6 +565,11 @@ const std::string &FA::getType() const
     return type;
 }
 
+size_t FA::getRevision() const
+{
+    return revision->load();
+}
+
 const std::set<Symbol> &FA::getAlphabet() const
 {
     return alphabet;
@@ -382,11 +583,25 @@ Symbol FA::getEpsilon() const
 void FA::setAlphabet(const std::set<Symbol> &alphbet)
 {
     alphabet = alphbet;
+    (*revision)++;
 }
 
 void FA::setEpsilon(Symbol eps)
 {
     epsilon = eps;
+    (*revision)++;
+}
+
+void FA::setStarting(const std::shared_ptr<State> &state, const bool starting)
+{
+    state->starting = starting;
+    (*revision)++;
+}
+
+void FA::setAccepting(const std::shared_ptr<State> &state, const bool accepting)
+{
+    state->accepting = accepting;
+    (*revision)++;
 }
 
 std::shared_ptr<State> FA::getStartingState() const
@@ -422,67 +637,80 @@ std::vector<std::shared_ptr<State>> FA::getAcceptingStates() const
     return acceptStates;
 }
 
-std::vector<std::shared_ptr<Transition>> FA::getTransitionsFromState(const std::shared_ptr<State> &state) const
+const TransitionList &FA::getTransitionsFromState(const std::shared_ptr<State> &state) const
 {
-    std::vector<std::shared_ptr<Transition>> transitionFromState;
-    for (const std::shared_ptr<Transition> &transition: transitions)
+    auto found = outgoing.find(state.get());
+    if (found == outgoing.end())
     {
-        if (transition->from == state)
-        {
-            transitionFromState.push_back(transition);
-        }
+        return NO_TRANSITIONS;
     }
-    return transitionFromState;
+    return found->second.all;
 }
 
-std::vector<std::shared_ptr<Transition>> FA::getTransitionsToState(const std::shared_ptr<State> &state) const
+const TransitionList &FA::getTransitionsFromState(const std::shared_ptr<State> &state, const Symbol symbol) const
 {
-    std::vector<std::shared_ptr<Transition>> transitionFromState;
-    for (const std::shared_ptr<Transition> &transition: transitions)
+    auto found = outgoing.find(state.get());
+    if (found == outgoing.end())
     {
-        if (transition->to == state)
-        {
-            transitionFromState.push_back(transition);
-        }
+        return NO_TRANSITIONS;
+    }
+    const TransitionList *bucket = found->second.find(symbol);
+    if (bucket == nullptr)
+    {
+        return NO_TRANSITIONS;
     }
-    return transitionFromState;
+    return *bucket;
+}
+
+const TransitionList &FA::getTransitionsToState(const std::shared_ptr<State> &state) const
+{
+    auto found = incoming.find(state.get());
+    if (found == incoming.end())
+    {
+        return NO_TRANSITIONS;
+    }
+    return found->second.all;
 }
 
 std::shared_ptr<State> FA::getState(const std::string &name) const
 {
-    for (const std::shared_ptr<State> &state: states)
+    // the first reader to get here names and indexes the derived states
+    std::lock_guard<std::mutex> lock(stateIdsLock.mutex);
+    if (!stateIdsComplete)
     {
-        if (state->name == name)
+        for (size_t id = 0; id < states.size(); id++)
         {
-            return state;
+            stateIds.emplace(states[id]->getName(), id);
         }
+        stateIdsComplete = true;
+    }
+    auto found = stateIds.find(name);
+    if (found == stateIds.end())
+    {
+        return nullptr;
     }
-    return nullptr;
+    return states[found->second];
 }
 
 std::shared_ptr<State> FA::getNextState(const std::shared_ptr<State> &from, const Symbol symbol) const
 {
-    for (const std::shared_ptr<Transition> &transition: transitions)
+    const TransitionList &next = getTransitionsFromState(from, symbol);
+    if (next.empty())
     {
-        if (transition->from == from && transition->symbol == symbol)
-        {
-            return transition->to;
-        }
+        return nullptr;
     }
-    return nullptr;
+    return next.front()->to;
 }
 
-std::shared_ptr<SetOfStates> FA::getNextStates(const std::shared_ptr<SetOfStates> &from, const Symbol symbol) const
+std::shared_ptr<SetOfStates> FA::getNextStates(const std::shared_ptr<SetOfStates> &from, const Symbol symbol,
+                                               Arena *scratch) const
 {
-    std::shared_ptr<SetOfStates> nextStates = std::make_shared<SetOfStates>();
+    std::shared_ptr<SetOfStates> nextStates = Arena::make<SetOfStates>(scratch, false, scratch);
     for (const std::shared_ptr<State> &state: from->states)
     {
-        for (const std::shared_ptr<Transition> &transition: transitions)
+        for (const std::shared_ptr<Transition> &transition: getTransitionsFromState(state, symbol))
         {
-            if (transition->from == state && transition->symbol == symbol)
-            {
-                nextStates->add(e_closure(transition->to, nextStates));
-            }
+            nextStates->add(e_closure(transition->to, nextStates));
         }
     }
     return nextStates;
@@ -494,9 +722,9 @@ std::shared_ptr<SetOfStates>
 FA::e_closure(const std::shared_ptr<State> &state, const std::shared_ptr<SetOfStates> &setofstates) const
 {
     setofstates->add(state);
-    for (const std::shared_ptr<Transition> &transition: transitions)
+    for (const std::shared_ptr<Transition> &transition: getTransitionsFromState(state, epsilon))
     {
-        if (transition->from == state && transition->symbol == epsilon && !setofstates->states.count(transition->to))
+        if (!setofstates->states.count(transition->to))
         {
             e_closure(transition->to, setofstates);
         }
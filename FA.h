@@ -5,10 +5,17 @@
 #ifndef AUTOMATA_FA_H
 #define AUTOMATA_FA_H
 
+#include <atomic>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include "json.hpp"
+#include "Arena.h"
+#include "StateNames.h"
 
 using json = nlohmann::json;
 using Symbol = char;
@@ -17,20 +24,34 @@ constexpr int SYMBOL_SIZE = 1;
 
 struct State
 {
-    std::string name;
+    // Assigning these directly is not seen by the caches of the automaton (the compiled table of a DFA,
+    // the determinized DFA of an NFA), change them through FA::setStarting and FA::setAccepting instead.
     bool starting;
     bool accepting;
 
-    State()
+    // states are made by FA::newState, their name is entry `id` of the names of the automaton
+    State(const StateNames *names, const StateNames::Id id, const bool isBegin, const bool isEnd)
+            : starting(isBegin), accepting(isEnd), names(names), id(id)
     {
-        name = "";
-        starting = false;
-        accepting = false;
     }
 
-    State(std::string name, const bool isBegin, const bool isEnd)
-            : name(std::move(name)), starting(isBegin), accepting(isEnd)
+    [[nodiscard]]
+    bool isNamed() const
+    {
+        return names->isNamed(id);
+    }
+
+    [[nodiscard]]
+    const std::string &getName() const
+    {
+        return names->get(id);
+    }
+
+    // this state as the part of a derived state
+    [[nodiscard]]
+    StateNames::Part asPart() const
     {
+        return {names, id};
     }
 
     [[nodiscard]]
@@ -38,26 +59,31 @@ struct State
     {
         json j;
 
-        j["name"] = name;
+        j["name"] = getName();
         j["starting"] = starting;
         j["accepting"] = accepting;
 
         return j;
     }
+
+private:
+    const StateNames *names;
+    StateNames::Id id;
 };
 
+class FA;
+
+// the states of a subset, allocated in the scratch arena of the construction that made it, if it has one
+using StateSet = std::set<std::shared_ptr<State>, std::less<>, ArenaAllocator<std::shared_ptr<State>>>;
+
 struct SetOfStates
 {
-    std::set<std::shared_ptr<State>> states;
+    StateSet states;
     std::shared_ptr<State> state = nullptr;
     bool isStarting = false;
 
-    explicit SetOfStates(const bool starting = false) : states({}), isStarting(starting)
-    {
-    }
-
-    explicit SetOfStates(const std::set<std::shared_ptr<State>> &states, const bool starting = false)
-            : states(states), isStarting(starting)
+    explicit SetOfStates(const bool starting = false, Arena *scratch = nullptr)
+            : states(StateSet::allocator_type(scratch)), isStarting(starting)
     {
     }
 
@@ -71,16 +97,13 @@ struct SetOfStates
         states.insert(set->states.begin(), set->states.end());
     }
 
-    std::shared_ptr<State> to_state()
+    // the state is made by `fa` the first time it is requested
+    std::shared_ptr<State> to_state(const FA &fa);
+
+    // the state made by an earlier to_state(fa)
+    [[nodiscard]]
+    const std::shared_ptr<State> &to_state() const
     {
-        if (state != nullptr)
-        {
-            return state;
-        }
-        state = std::make_shared<State>();
-        state->name = to_string();
-        state->starting = isStarting;
-        state->accepting = isAccepting();
         return state;
     }
 
@@ -92,29 +115,6 @@ struct SetOfStates
                 states.end(),
                 [](const std::shared_ptr<State> &s) -> bool { return s->accepting; });
     }
-
-    [[nodiscard]]
-    std::string to_string() const
-    {
-        std::string result = "{";
-        std::vector<std::string> all_names;
-        all_names.reserve(states.size());
-        for (const std::shared_ptr<State> &s: states)
-        {
-            all_names.push_back(s->name);
-        }
-        std::sort(all_names.begin(), all_names.end());
-        for (const std::string &name: all_names)
-        {
-            if (name != all_names.front())
-            {
-                result += ",";
-            }
-            result += name;
-        }
-        result += "}";
-        return result;
-    }
 };
 
 struct PairOfStates
@@ -134,24 +134,14 @@ struct PairOfStates
     {
     }
 
-    [[nodiscard]]
-    std::shared_ptr<State> to_state()
-    {
-        if (state != nullptr)
-        {
-            return state;
-        }
-        state = std::make_shared<State>();
-        state->name = to_string();
-        state->starting = isStarting;
-        state->accepting = isAccepting;
-        return state;
-    }
+    // the state is made by `fa` the first time it is requested
+    std::shared_ptr<State> to_state(const FA &fa);
 
+    // the state made by an earlier to_state(fa)
     [[nodiscard]]
-    std::string to_string() const
+    const std::shared_ptr<State> &to_state() const
     {
-        return "(" + states.first->name + "," + states.second->name + ")";
+        return state;
     }
 };
 
@@ -180,14 +170,93 @@ struct Transition
     {
         json j;
 
-        j["from"] = from->name;
-        j["to"] = to->name;
+        j["from"] = from->getName();
+        j["to"] = to->getName();
         j["input"] = std::string().assign(1, symbol);
 
         return j;
     }
 };
 
+// the transitions of one state, allocated in the arena of its automaton
+using TransitionList = std::vector<std::shared_ptr<Transition>, ArenaAllocator<std::shared_ptr<Transition>>>;
+
+// The transitions leaving (or entering) a single state, bucketed by symbol.
+struct StateTransitions
+{
+    using Bucket = std::pair<Symbol, TransitionList>;
+
+    TransitionList all;
+    std::vector<Bucket, ArenaAllocator<Bucket>> bySymbol;
+
+    explicit StateTransitions(Arena *arena) : all(TransitionList::allocator_type(arena)), bySymbol(all.get_allocator())
+    {
+    }
+
+    void add(const std::shared_ptr<Transition> &transition)
+    {
+        all.push_back(transition);
+        for (Bucket &bucket: bySymbol)
+        {
+            if (bucket.first == transition->symbol)
+            {
+                bucket.second.push_back(transition);
+                return;
+            }
+        }
+        bySymbol.emplace_back(transition->symbol, TransitionList({transition}, all.get_allocator()));
+    }
+
+    void remove(const std::shared_ptr<Transition> &transition)
+    {
+        all.erase(std::remove(all.begin(), all.end(), transition), all.end());
+        for (Bucket &bucket: bySymbol)
+        {
+            if (bucket.first == transition->symbol)
+            {
+                bucket.second.erase(std::remove(bucket.second.begin(), bucket.second.end(), transition),
+                                    bucket.second.end());
+            }
+        }
+    }
+
+    [[nodiscard]]
+    const TransitionList *find(const Symbol symbol) const
+    {
+        for (const Bucket &bucket: bySymbol)
+        {
+            if (bucket.first == symbol)
+            {
+                return &bucket.second;
+            }
+        }
+        return nullptr;
+    }
+};
+
+struct TransitionKey
+{
+    const State *from;
+    const State *to;
+    Symbol symbol;
+
+    bool operator==(const TransitionKey &other) const
+    {
+        return from == other.from && to == other.to && symbol == other.symbol;
+    }
+};
+
+struct TransitionKeyHash
+{
+    size_t operator()(const TransitionKey &key) const
+    {
+        size_t hash = std::hash<const State *>()(key.from);
+        hash ^= std::hash<const State *>()(key.to) + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+        hash ^= static_cast<unsigned char>(key.symbol) + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+        return hash;
+    }
+};
+
 class DFA;
 
 class FA
@@ -195,8 +264,17 @@ class FA
 public:
     explicit FA(const std::string &type);
 
+    FA(const FA &other) = default;
+
+    // moving hands over the states, transitions, indexes and arena without touching them
+    FA(FA &&other) noexcept = default;
+
     virtual ~FA();
 
+    FA &operator=(const FA &other) = default;
+
+    FA &operator=(FA &&other) noexcept = default;
+
     void clear();
 
     void fromPath(const std::string &file_path);
@@ -223,13 +301,42 @@ public:
 
     void printStats() const;
 
+    // allocates a state or transition in this automaton's arena, it still has to be added
+    [[nodiscard]]
+    std::shared_ptr<State> newState(std::string name, bool starting, bool accepting) const;
+
+    // a copy of `source` named `prefix` + its name, the name is only built when asked for
+    [[nodiscard]]
+    std::shared_ptr<State>
+    newState(std::string prefix, const std::shared_ptr<State> &source, bool starting, bool accepting) const;
+
+    // a state named after `parts` as a set or a pair, the name is only built when asked for
+    [[nodiscard]]
+    std::shared_ptr<State>
+    newState(Naming naming, std::vector<StateNames::Part> parts, bool starting, bool accepting) const;
+
+    [[nodiscard]]
+    std::shared_ptr<Transition>
+    newTransition(const std::shared_ptr<State> &from, const std::shared_ptr<State> &to, Symbol symbol) const;
+
+    [[nodiscard]]
+    const std::shared_ptr<Arena> &getArena() const;
+
     void addState(const std::shared_ptr<State> &state);
 
     void addTransition(const std::shared_ptr<Transition> &transition);
 
+    // trusted bulk insert: skips the duplicate check, the caller guarantees that the transitions
+    // are unique and that their endpoints are the states stored in this automaton
+    void addUniqueTransitions(const std::vector<std::shared_ptr<Transition>> &new_transitions);
+
     [[nodiscard]]
     const std::string &getType() const;
 
+    // incremented on every mutation of this automaton or of a copy, used to invalidate derived caches
+    [[nodiscard]]
+    size_t getRevision() const;
+
     [[nodiscard]]
     const std::set<Symbol> &getAlphabet() const;
 
@@ -240,6 +347,11 @@ public:
 
     void setEpsilon(Symbol epsilon);
 
+    // changes a flag of a state of this automaton and invalidates the derived caches
+    void setStarting(const std::shared_ptr<State> &state, bool starting);
+
+    void setAccepting(const std::shared_ptr<State> &state, bool accepting);
+
     [[nodiscard]]
     std::shared_ptr<State> getStartingState() const;
 
@@ -256,10 +368,13 @@ public:
     const std::vector<std::shared_ptr<Transition>> &getTransitions() const;
 
     [[nodiscard]]
-    std::vector<std::shared_ptr<Transition>> getTransitionsFromState(const std::shared_ptr<State> &state) const;
+    const TransitionList &getTransitionsFromState(const std::shared_ptr<State> &state) const;
+
+    [[nodiscard]]
+    const TransitionList &getTransitionsFromState(const std::shared_ptr<State> &state, Symbol symbol) const;
 
     [[nodiscard]]
-    std::vector<std::shared_ptr<Transition>> getTransitionsToState(const std::shared_ptr<State> &state) const;
+    const TransitionList &getTransitionsToState(const std::shared_ptr<State> &state) const;
 
     [[nodiscard]]
     std::shared_ptr<State> getState(const std::string &name) const;
@@ -267,13 +382,58 @@ public:
     [[nodiscard]]
     std::shared_ptr<State> getNextState(const std::shared_ptr<State> &from, Symbol symbol) const;
 
+    // the resulting set and its nodes are allocated in `scratch` when given
     [[nodiscard]]
-    std::shared_ptr<SetOfStates> getNextStates(const std::shared_ptr<SetOfStates> &from, Symbol symbol) const;
+    std::shared_ptr<SetOfStates> getNextStates(const std::shared_ptr<SetOfStates> &from, Symbol symbol,
+                                               Arena *scratch = nullptr) const;
 
     // modifies the given set of states
     std::shared_ptr<SetOfStates> e_closure(const std::shared_ptr<State> &state, const std::shared_ptr<SetOfStates> &states) const;
 
 protected:
+    // the last state takes the place of the removed one, so a named state is removed in constant time
+    void removeState(const std::shared_ptr<State> &state);
+
+    void removeTransition(const std::shared_ptr<Transition> &transition);
+
+    void moveTransition(const std::shared_ptr<Transition> &transition,
+                        const std::shared_ptr<State> &from, const std::shared_ptr<State> &to);
+
+    // the stored state with the same name as `state`, without naming derived states
+    [[nodiscard]]
+    std::shared_ptr<State> findIndexedState(const State &state) const;
+
+    void indexTransition(const std::shared_ptr<Transition> &transition);
+
+    using TransitionIndex = std::unordered_map<const State *, StateTransitions, std::hash<const State *>,
+            std::equal_to<>, ArenaAllocator<std::pair<const State *const, StateTransitions>>>;
+
+    using StateIndex = std::unordered_map<std::string_view, size_t, std::hash<std::string_view>, std::equal_to<>,
+            ArenaAllocator<std::pair<const std::string_view, size_t>>>;
+
+    using TransitionKeys = std::unordered_set<TransitionKey, TransitionKeyHash, std::equal_to<>,
+            ArenaAllocator<TransitionKey>>;
+
+    // the entry of `state`, made in the arena of `index` if there is none yet
+    static StateTransitions &transitionsOf(TransitionIndex &index, const State *state);
+
+    // a mutex that is not copied along with the automaton, every copy locks its own
+    struct IndexLock
+    {
+        std::mutex mutex;
+
+        IndexLock() = default;
+
+        IndexLock(const IndexLock &)
+        {
+        }
+
+        IndexLock &operator=(const IndexLock &)
+        {
+            return *this;
+        }
+    };
+
     void validateAlphabetAndStore(const nlohmann::json &alphabet_array);
 
     void validateStatesAndStore(const nlohmann::json &states_array);
@@ -282,14 +442,36 @@ protected:
 
 protected:
     std::string type;
+    // owns the memory of every state and transition made by newState/newTransition and of the indexes,
+    // shared by copies
+    std::shared_ptr<Arena> arena = Arena::create();
+    // the names of the states made by newState, shared by copies
+    std::shared_ptr<StateNames> names = std::make_shared<StateNames>();
     std::set<Symbol> alphabet;
     std::vector<std::shared_ptr<State>> states;
     std::vector<std::shared_ptr<Transition>> transitions;
     std::shared_ptr<State> startingState = nullptr;
 
+    // adjacency indexes over `transitions`, kept in sync by every mutator, allocated in the arena
+    TransitionIndex outgoing = TransitionIndex(TransitionIndex::allocator_type(arena.get()));
+    TransitionIndex incoming = TransitionIndex(TransitionIndex::allocator_type(arena.get()));
+
+    // name -> index into `states`, the keys view the names owned by the states themselves;
+    // derived states are only indexed (and named) on the first lookup by name, readers do that under stateIdsLock
+    mutable StateIndex stateIds = StateIndex(StateIndex::allocator_type(arena.get()));
+    mutable bool stateIdsComplete = true;
+    mutable IndexLock stateIdsLock;
+
+    // (from, symbol, to) of every transition, rebuilt lazily after a trusted insert
+    TransitionKeys transitionKeys = TransitionKeys(TransitionKeys::allocator_type(arena.get()));
+    bool transitionKeysStale = false;
+
     bool allowEpsilonTransitions = false;
     // if epsilon is not used, it will be '\0'
     Symbol epsilon = '\0';
+
+    // bumped by every mutation, shared by copies because they share their states
+    std::shared_ptr<std::atomic<size_t>> revision = std::make_shared<std::atomic<size_t>>(0);
 };
 
 
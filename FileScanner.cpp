@@ -0,0 +1,125 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "FileScanner.h"
+
+namespace
+{
+    // a read-only mapping of a whole file, unmapped when it goes out of scope
+    class MappedFile
+    {
+    public:
+        explicit MappedFile(const std::string &file_path)
+        {
+            const int fd = open(file_path.c_str(), O_RDONLY);
+            if (fd == -1)
+            {
+                throw std::runtime_error("file could not be opened: " + file_path + ": " + std::strerror(errno));
+            }
+            struct stat status{};
+            if (fstat(fd, &status) == -1)
+            {
+                close(fd);
+                throw std::runtime_error("file could not be read: " + file_path + ": " + std::strerror(errno));
+            }
+            size = static_cast<size_t>(status.st_size);
+            // an empty file can not be mapped, there is nothing to read either
+            if (size != 0)
+            {
+                void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapped == MAP_FAILED)
+                {
+                    close(fd);
+                    throw std::runtime_error("file could not be mapped: " + file_path + ": " + std::strerror(errno));
+                }
+                data = static_cast<const char *>(mapped);
+                // only a hint, the scan is correct without it
+                madvise(mapped, size, MADV_SEQUENTIAL);
+            }
+            close(fd);
+        }
+
+        MappedFile(const MappedFile &) = delete;
+
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        ~MappedFile()
+        {
+            if (data != nullptr)
+            {
+                munmap(const_cast<char *>(data), size);
+            }
+        }
+
+        const char *data = nullptr;
+        size_t size = 0;
+    };
+}
+
+FileScanner::FileScanner(const FA &fa, const char delimiter) : frozen(fa), prefilter(frozen.getCompiled()), delimiter(delimiter)
+{
+}
+
+FileScanner::Result FileScanner::scan(const std::string &file_path, const Report report) const
+{
+    const MappedFile file(file_path);
+    return scan(file.data, file.size, report);
+}
+
+FileScanner::Result FileScanner::scan(const char *data, const size_t size, const Report report) const
+{
+    const CompiledDFA &compiled = frozen.getCompiled();
+    const int32_t start = compiled.getStartingState();
+
+    // the next occurrence of the literal, found on the whole buffer rather than line by line
+    // a literal holding the delimiter can not occur in a line at all
+    const bool filtered = !prefilter.getLiteral().empty();
+    const bool impossible = prefilter.getLiteral().find(delimiter) != std::string::npos;
+    size_t hit = filtered && !impossible ? prefilter.find(data, size) : 0;
+
+    Result result;
+    size_t offset = 0;
+    // a delimiter at the very end does not start another line
+    while (offset < size)
+    {
+        const char *begin = data + offset;
+        const auto *found = static_cast<const char *>(std::memchr(begin, delimiter, size - offset));
+        const size_t length = found == nullptr ? size - offset : found - begin;
+
+        if (filtered && !impossible && hit < offset)
+        {
+            hit = offset + prefilter.find(begin, size - offset);
+        }
+        const bool skipped = filtered && (impossible || hit + prefilter.getLiteral().size() > offset + length);
+        const bool accepted = !skipped && compiled.isAccepting(compiled.run(start, begin, length));
+        if (accepted)
+        {
+            result.accepted++;
+            if (report == Report::OFFSETS)
+            {
+                result.offsets.push_back(offset);
+            }
+        }
+        if (report == Report::BITMAP)
+        {
+            if (result.lines % 64 == 0)
+            {
+                result.bitmap.push_back(0);
+            }
+            result.bitmap.back() |= uint64_t(accepted) << (result.lines % 64);
+        }
+        result.lines++;
+        offset += length + 1;
+    }
+    return result;
+}
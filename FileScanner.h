@@ -0,0 +1,57 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#ifndef AUTOMATA_FILESCANNER_H
+#define AUTOMATA_FILESCANNER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "FA.h"
+#include "FrozenFA.h"
+#include "Prefilter.h"
+
+// Matches every line (or record) of a file against an automaton.
+// The file is memory mapped and read sequentially, lines are matched in place on the
+// compiled table of the automaton and never copied into a string.
+// Lines without the literal every accepted line contains are rejected without running the automaton.
+class FileScanner
+{
+public:
+    // what is reported next to the counts
+    enum class Report : uint8_t
+    {
+        COUNT,
+        // the byte offset of every accepted line
+        OFFSETS,
+        // one bit per line, set if the line is accepted
+        BITMAP
+    };
+
+    struct Result
+    {
+        size_t lines = 0;
+        size_t accepted = 0;
+        std::vector<size_t> offsets;
+        std::vector<uint64_t> bitmap;
+    };
+
+    explicit FileScanner(const FA &fa, char delimiter = '\n');
+
+    [[nodiscard]]
+    Result scan(const std::string &file_path, Report report = Report::COUNT) const;
+
+    // the same for data that is already in memory
+    [[nodiscard]]
+    Result scan(const char *data, size_t size, Report report = Report::COUNT) const;
+
+private:
+    FrozenFA frozen;
+    Prefilter prefilter;
+    char delimiter;
+};
+
+
+#endif //AUTOMATA_FILESCANNER_H
@@ -0,0 +1,52 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#include "FrozenFA.h"
+#include "DFA.h"
+#include "NFA.h"
+
+namespace
+{
+    CompiledDFA compile(const FA &fa)
+    {
+        if (const auto *dfa = dynamic_cast<const DFA *>(&fa))
+        {
+            return CompiledDFA(*dfa);
+        }
+        if (const auto *nfa = dynamic_cast<const NFA *>(&fa))
+        {
+            return CompiledDFA(nfa->toDFA());
+        }
+        throw std::runtime_error("Cannot freeze an automaton of type '" + fa.getType() + "'");
+    }
+}
+
+FrozenFA::FrozenFA(const FA &fa) : type(fa.getType()), revision(fa.getRevision()), compiled(compile(fa))
+{
+}
+
+bool FrozenFA::accepts(const std::string &string) const
+{
+    return compiled.accepts(string.data(), string.size());
+}
+
+bool FrozenFA::accepts(const char *data, const size_t size) const
+{
+    return compiled.accepts(data, size);
+}
+
+const std::string &FrozenFA::getType() const
+{
+    return type;
+}
+
+size_t FrozenFA::getRevision() const
+{
+    return revision;
+}
+
+const CompiledDFA &FrozenFA::getCompiled() const
+{
+    return compiled;
+}
@@ -0,0 +1,50 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#ifndef AUTOMATA_FROZENFA_H
+#define AUTOMATA_FROZENFA_H
+
+#include <string>
+
+#include "FA.h"
+#include "CompiledDFA.h"
+
+// An immutable snapshot of an automaton of any type.
+// NFAs and ENFAs are determinized once, the result is kept as a plain transition table,
+// so matching never touches a shared_ptr, a lazily filled cache or any other mutable state
+// and a snapshot can be read from any number of threads at once.
+class FrozenFA
+{
+public:
+    explicit FrozenFA(const FA &fa);
+
+    FrozenFA(const FrozenFA &) = delete;
+
+    FrozenFA &operator=(const FrozenFA &) = delete;
+
+    [[nodiscard]]
+    bool accepts(const std::string &string) const;
+
+    [[nodiscard]]
+    bool accepts(const char *data, size_t size) const;
+
+    // the type of the automaton this snapshot was made from
+    [[nodiscard]]
+    const std::string &getType() const;
+
+    // the revision of the automaton this snapshot was made from
+    [[nodiscard]]
+    size_t getRevision() const;
+
+    [[nodiscard]]
+    const CompiledDFA &getCompiled() const;
+
+private:
+    const std::string type;
+    const size_t revision;
+    const CompiledDFA compiled;
+};
+
+
+#endif //AUTOMATA_FROZENFA_H
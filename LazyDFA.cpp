@@ -0,0 +1,162 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#include <algorithm>
+
+#include "LazyDFA.h"
+
+LazyDFA::LazyDFA(const FA &fa, const size_t budget)
+        : nfa(fa), classes(fa), stride(classes.size()), budget(budget), representatives(stride, -1)
+{
+    for (size_t byte = 0; byte < 256; byte++)
+    {
+        const auto symbol = static_cast<Symbol>(byte);
+        if (representatives[classes.get(symbol)] == -1 && (fa.getEpsilon() == '\0' || symbol != fa.getEpsilon()))
+        {
+            representatives[classes.get(symbol)] = static_cast<int>(byte);
+        }
+    }
+
+    inNext.assign((nfa.size() + 63) / 64, 0);
+    if (nfa.getStartingState() != CSRAutomaton::NO_STATE)
+    {
+        start.push_back(nfa.getStartingState());
+        inNext[start.front() / 64] |= uint64_t(1) << (start.front() % 64);
+        nfa.e_closure(start, inNext);
+        std::fill(inNext.begin(), inNext.end(), 0);
+        prune(start);
+    }
+}
+
+bool LazyDFA::accepts(const std::string &string) const
+{
+    return accepts(string.data(), string.size());
+}
+
+bool LazyDFA::accepts(const char *data, const size_t size) const
+{
+    int32_t state = stateOf(start);
+    for (size_t i = 0; i < size && state != DEAD; i++)
+    {
+        state = step(state, classes.get(data[i]));
+    }
+    return state != DEAD && accepting[state];
+}
+
+size_t LazyDFA::getCachedStates() const
+{
+    return subsets.size();
+}
+
+size_t LazyDFA::getCacheClears() const
+{
+    return clears;
+}
+
+size_t LazyDFA::memoryUsage() const
+{
+    return used;
+}
+
+size_t LazyDFA::SubsetHash::operator()(const Subset &subset) const
+{
+    size_t hash = subset.size();
+    for (const CSRAutomaton::StateId state: subset)
+    {
+        hash ^= state + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+    }
+    return hash;
+}
+
+int32_t LazyDFA::stateOf(const Subset &subset) const
+{
+    if (subset.empty())
+    {
+        return DEAD;
+    }
+    const auto found = ids.find(subset);
+    if (found != ids.end())
+    {
+        return found->second;
+    }
+
+    // the subset, its hash map entry and its row of the table
+    const size_t cost = subset.size() * sizeof(CSRAutomaton::StateId) + sizeof(Subset) + 4 * sizeof(void *)
+                        + stride * sizeof(int32_t);
+    if (used + cost > budget && !subsets.empty())
+    {
+        clear();
+    }
+    used += cost;
+
+    const auto state = static_cast<int32_t>(subsets.size());
+    const auto inserted = ids.emplace(subset, state).first;
+    subsets.push_back(&inserted->first);
+    table.insert(table.end(), stride, UNKNOWN);
+    accepting.push_back(std::any_of(subset.begin(), subset.end(), [this](const CSRAutomaton::StateId s) {
+        return nfa.isAccepting(s);
+    }));
+    return state;
+}
+
+int32_t LazyDFA::step(const int32_t state, const uint8_t byte_class) const
+{
+    const int32_t known = table[state * stride + byte_class];
+    if (known != UNKNOWN)
+    {
+        return known;
+    }
+
+    next.clear();
+    if (representatives[byte_class] != -1)
+    {
+        const auto symbol = static_cast<Symbol>(representatives[byte_class]);
+        for (const CSRAutomaton::StateId from: *subsets[state])
+        {
+            const CSRAutomaton::Edges edges = nfa.getTransitionsFromState(from, symbol);
+            for (size_t edge = edges.first; edge < edges.last; edge++)
+            {
+                const CSRAutomaton::StateId to = nfa.getTarget(edge);
+                if (!((inNext[to / 64] >> (to % 64)) & 1))
+                {
+                    inNext[to / 64] |= uint64_t(1) << (to % 64);
+                    next.push_back(to);
+                }
+            }
+        }
+        nfa.e_closure(next, inNext);
+        for (const CSRAutomaton::StateId s: next)
+        {
+            inNext[s / 64] = 0;
+        }
+        prune(next);
+    }
+
+    // a clear invalidates `state`, the transition is then not remembered
+    const size_t clears_before = clears;
+    const int32_t to = stateOf(next);
+    if (clears == clears_before)
+    {
+        table[state * stride + byte_class] = to;
+    }
+    return to;
+}
+
+void LazyDFA::prune(Subset &subset) const
+{
+    subset.erase(std::remove_if(subset.begin(), subset.end(), [this](const CSRAutomaton::StateId s) {
+        return !nfa.isLive(s);
+    }), subset.end());
+    std::sort(subset.begin(), subset.end());
+}
+
+void LazyDFA::clear() const
+{
+    ids.clear();
+    subsets.clear();
+    table.clear();
+    accepting.clear();
+    used = 0;
+    clears++;
+}
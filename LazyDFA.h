@@ -0,0 +1,94 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#ifndef AUTOMATA_LAZYDFA_H
+#define AUTOMATA_LAZYDFA_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "FA.h"
+#include "ByteClasses.h"
+#include "CSRAutomaton.h"
+
+// Determinizes an NFA or ENFA while matching: a DFA state (a set of automaton states) and its
+// transitions are only built when the input reaches them, and are remembered for later input.
+// The remembered states are bounded by a byte budget, once it is exceeded the cache is cleared and
+// rebuilt from the state the match is in, so memory stays bounded however large the full DFA is.
+// Subsets only hold states that can still reach an accepting state, so a subset that can no longer
+// accept is empty and is the dead state, where the match stops.
+// The cache is filled by const calls, a LazyDFA must not be used by several threads at once.
+class LazyDFA
+{
+public:
+    static constexpr size_t DEFAULT_BUDGET = size_t(1) << 20;
+
+    explicit LazyDFA(const FA &fa, size_t budget = DEFAULT_BUDGET);
+
+    [[nodiscard]]
+    bool accepts(const std::string &string) const;
+
+    [[nodiscard]]
+    bool accepts(const char *data, size_t size) const;
+
+    // the number of DFA states in the cache
+    [[nodiscard]]
+    size_t getCachedStates() const;
+
+    // how often the cache was cleared because it exceeded the budget
+    [[nodiscard]]
+    size_t getCacheClears() const;
+
+    // the bytes accounted to the cache
+    [[nodiscard]]
+    size_t memoryUsage() const;
+
+private:
+    using Subset = std::vector<CSRAutomaton::StateId>;
+
+    struct SubsetHash
+    {
+        size_t operator()(const Subset &subset) const;
+    };
+
+    static constexpr int32_t DEAD = -1;
+    // a transition that was not taken yet
+    static constexpr int32_t UNKNOWN = -2;
+
+    // the state for `subset`, added to the cache if it is not in it
+    int32_t stateOf(const Subset &subset) const;
+
+    int32_t step(int32_t state, uint8_t byte_class) const;
+
+    // drops the states that can not reach an accepting state and sorts the rest
+    void prune(Subset &subset) const;
+
+    void clear() const;
+
+private:
+    CSRAutomaton nfa;
+    ByteClasses classes;
+    size_t stride = 0;
+    size_t budget;
+    // one byte of every class that stands for it, -1 for the class of epsilon
+    std::vector<int> representatives;
+    Subset start;
+
+    mutable std::unordered_map<Subset, int32_t, SubsetHash> ids;
+    mutable std::vector<const Subset *> subsets;
+    // row-major [state][class]
+    mutable std::vector<int32_t> table;
+    mutable std::vector<bool> accepting;
+    mutable size_t used = 0;
+    mutable size_t clears = 0;
+
+    // scratch space of step
+    mutable Subset next;
+    mutable std::vector<uint64_t> inNext;
+};
+
+
+#endif //AUTOMATA_LAZYDFA_H
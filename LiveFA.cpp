@@ -0,0 +1,131 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#include <thread>
+
+#include "LiveFA.h"
+
+LiveFA::Reader::Reader(LiveFA &live) : live(live), slot(live.claimSlot())
+{
+}
+
+LiveFA::Reader::~Reader()
+{
+    slot.claimed.store(false, std::memory_order_release);
+}
+
+bool LiveFA::Reader::accepts(const std::string &string)
+{
+    return accepts(string.data(), string.size());
+}
+
+bool LiveFA::Reader::accepts(const char *data, const size_t size)
+{
+    return read([data, size](const FrozenFA *snapshot) {
+        return snapshot != nullptr && snapshot->accepts(data, size);
+    });
+}
+
+LiveFA::LiveFA() = default;
+
+LiveFA::LiveFA(const FA &fa)
+{
+    publish(fa);
+}
+
+LiveFA::~LiveFA()
+{
+    delete current.load();
+    for (const Retired &old: retired)
+    {
+        delete old.snapshot;
+    }
+}
+
+void LiveFA::publish(const FA &fa)
+{
+    // freezing can be slow, it happens before the writer lock is taken
+    publish(std::make_unique<const FrozenFA>(fa));
+}
+
+void LiveFA::publish(std::unique_ptr<const FrozenFA> snapshot)
+{
+    std::lock_guard<std::mutex> lock(writer);
+    const FrozenFA *previous = current.exchange(snapshot.release());
+    // readers that announced this epoch or an earlier one may still hold `previous`
+    const uint64_t retired_in = epoch.fetch_add(1);
+    if (previous != nullptr)
+    {
+        retired.push_back({previous, retired_in});
+    }
+    reclaim();
+}
+
+void LiveFA::synchronize()
+{
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(writer);
+            reclaim();
+            if (retired.empty())
+            {
+                return;
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
+size_t LiveFA::getRetiredCount()
+{
+    std::lock_guard<std::mutex> lock(writer);
+    return retired.size();
+}
+
+LiveFA::Slot &LiveFA::claimSlot()
+{
+    for (Slot &slot: slots)
+    {
+        bool expected = false;
+        if (slot.claimed.compare_exchange_strong(expected, true))
+        {
+            return slot;
+        }
+    }
+    throw std::runtime_error("Cannot have more than " + std::to_string(MAX_READERS) + " readers");
+}
+
+void LiveFA::reclaim()
+{
+    if (retired.empty())
+    {
+        return;
+    }
+
+    // the oldest epoch a reader is still in
+    uint64_t oldest = UINT64_MAX;
+    for (const Slot &slot: slots)
+    {
+        const uint64_t in = slot.epoch.load();
+        if (in != 0 && in < oldest)
+        {
+            oldest = in;
+        }
+    }
+
+    size_t kept = 0;
+    for (const Retired &old: retired)
+    {
+        if (old.epoch < oldest)
+        {
+            delete old.snapshot;
+        }
+        else
+        {
+            retired[kept++] = old;
+        }
+    }
+    retired.resize(kept);
+}
@@ -0,0 +1,128 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#ifndef AUTOMATA_LIVEFA_H
+#define AUTOMATA_LIVEFA_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "FrozenFA.h"
+
+// Holds the current FrozenFA of an automaton that can be replaced while other threads match against it.
+// Reads are RCU-like: a reader announces the epoch it started in, loads the current snapshot and
+// uses it without taking a lock or touching a reference count. publish() swaps in a new snapshot
+// right away, the previous one is freed once no reader that could still see it is active.
+class LiveFA
+{
+private:
+    struct alignas(64) Slot
+    {
+        std::atomic<bool> claimed{false};
+        // the epoch in which the current read started, 0 when the reader is idle
+        std::atomic<uint64_t> epoch{0};
+    };
+
+public:
+    static constexpr size_t MAX_READERS = 64;
+
+    // A reader owns one slot of a LiveFA, it is meant to be created once per thread.
+    class Reader
+    {
+    public:
+        explicit Reader(LiveFA &live);
+
+        Reader(const Reader &) = delete;
+
+        Reader &operator=(const Reader &) = delete;
+
+        ~Reader();
+
+        // false as long as nothing was published
+        [[nodiscard]]
+        bool accepts(const std::string &string);
+
+        [[nodiscard]]
+        bool accepts(const char *data, size_t size);
+
+        // calls `f` with the snapshot that was current when the read started (nullptr if there is none),
+        // the snapshot stays valid until `f` returns
+        template<typename F>
+        auto read(F &&f) -> decltype(f(static_cast<const FrozenFA *>(nullptr)));
+
+    private:
+        struct Leave
+        {
+            Slot &slot;
+
+            ~Leave()
+            {
+                slot.epoch.store(0, std::memory_order_release);
+            }
+        };
+
+        LiveFA &live;
+        Slot &slot;
+    };
+
+    LiveFA();
+
+    explicit LiveFA(const FA &fa);
+
+    LiveFA(const LiveFA &) = delete;
+
+    LiveFA &operator=(const LiveFA &) = delete;
+
+    // every reader must be gone by now
+    ~LiveFA();
+
+    // freezes `fa` and makes it the current snapshot
+    void publish(const FA &fa);
+
+    void publish(std::unique_ptr<const FrozenFA> snapshot);
+
+    // blocks until every replaced snapshot has been freed
+    void synchronize();
+
+    // the number of replaced snapshots that still wait for their readers
+    [[nodiscard]]
+    size_t getRetiredCount();
+
+private:
+    struct Retired
+    {
+        const FrozenFA *snapshot;
+        uint64_t epoch;
+    };
+
+    Slot &claimSlot();
+
+    // frees the retired snapshots no reader can reach anymore, the writer lock must be held
+    void reclaim();
+
+private:
+    std::atomic<const FrozenFA *> current{nullptr};
+    std::atomic<uint64_t> epoch{1};
+    std::array<Slot, MAX_READERS> slots;
+
+    std::mutex writer;
+    std::vector<Retired> retired;
+};
+
+template<typename F>
+auto LiveFA::Reader::read(F &&f) -> decltype(f(static_cast<const FrozenFA *>(nullptr)))
+{
+    // the epoch has to be visible before the snapshot is loaded, hence the sequentially consistent order
+    slot.epoch.store(live.epoch.load());
+    Leave leave{slot};
+    return f(live.current.load());
+}
+
+
+#endif //AUTOMATA_LIVEFA_H
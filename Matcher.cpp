@@ -0,0 +1,121 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#include <algorithm>
+
+#include "Matcher.h"
+#include "DFA.h"
+
+Matcher::Matcher(const FA &fa)
+{
+    if (const auto *automaton = dynamic_cast<const DFA *>(&fa))
+    {
+        dfa = automaton->compile();
+    }
+    else
+    {
+        nfa = std::make_shared<const CSRAutomaton>(fa);
+        inCurrent.assign((nfa->size() + 63) / 64, 0);
+        inNext.assign(inCurrent.size(), 0);
+    }
+    reset();
+}
+
+void Matcher::feed(const char *data, const size_t size)
+{
+    if (dfa != nullptr)
+    {
+        state = dfa->run(state, data, size);
+        return;
+    }
+
+    for (size_t i = 0; i < size && !current.empty(); i++)
+    {
+        step(data[i]);
+    }
+}
+
+void Matcher::feed(const std::string_view chunk)
+{
+    feed(chunk.data(), chunk.size());
+}
+
+bool Matcher::isAccepting() const
+{
+    if (dfa != nullptr)
+    {
+        return dfa->isAccepting(state);
+    }
+    return std::any_of(current.begin(), current.end(), [this](const CSRAutomaton::StateId s) {
+        return nfa->isAccepting(s);
+    });
+}
+
+bool Matcher::isDead() const
+{
+    if (dfa != nullptr)
+    {
+        return state == dfa->getDeadState();
+    }
+    return current.empty();
+}
+
+void Matcher::reset()
+{
+    if (dfa != nullptr)
+    {
+        state = dfa->getStartingState();
+        return;
+    }
+
+    std::fill(inCurrent.begin(), inCurrent.end(), 0);
+    current.clear();
+    const CSRAutomaton::StateId start = nfa->getStartingState();
+    if (start != CSRAutomaton::NO_STATE)
+    {
+        current.push_back(start);
+        inCurrent[start / 64] |= uint64_t(1) << (start % 64);
+        nfa->e_closure(current, inCurrent);
+        prune(current, inCurrent);
+    }
+}
+
+void Matcher::step(const Symbol symbol)
+{
+    next.clear();
+    for (const CSRAutomaton::StateId from: current)
+    {
+        const CSRAutomaton::Edges edges = nfa->getTransitionsFromState(from, symbol);
+        for (size_t edge = edges.first; edge < edges.last; edge++)
+        {
+            const CSRAutomaton::StateId to = nfa->getTarget(edge);
+            if (!((inNext[to / 64] >> (to % 64)) & 1))
+            {
+                inNext[to / 64] |= uint64_t(1) << (to % 64);
+                next.push_back(to);
+            }
+        }
+    }
+    nfa->e_closure(next, inNext);
+    prune(next, inNext);
+
+    for (const CSRAutomaton::StateId s: current)
+    {
+        inCurrent[s / 64] = 0;
+    }
+    std::swap(current, next);
+    std::swap(inCurrent, inNext);
+}
+
+void Matcher::prune(std::vector<CSRAutomaton::StateId> &set, std::vector<uint64_t> &in_set) const
+{
+    set.erase(std::remove_if(set.begin(), set.end(), [this, &in_set](const CSRAutomaton::StateId s) {
+        if (nfa->isLive(s))
+        {
+            return false;
+        }
+        in_set[s / 64] &= ~(uint64_t(1) << (s % 64));
+        return true;
+    }), set.end());
+}
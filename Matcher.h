@@ -0,0 +1,64 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#ifndef AUTOMATA_MATCHER_H
+#define AUTOMATA_MATCHER_H
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "FA.h"
+#include "CompiledDFA.h"
+#include "CSRAutomaton.h"
+
+// Matches input that arrives in chunks against an automaton.
+// Only the current state (DFA) or set of states (NFA, ENFA) is kept between chunks, a chunk is
+// read in place and never copied, so feeding a long input costs no memory beyond the automaton.
+// States from which no accepting state can be reached are dropped from the set as soon as they are
+// entered, so the set is empty exactly when the matcher is dead.
+// The matcher works on its own copy of the automaton, later changes to `fa` are not seen.
+class Matcher
+{
+public:
+    explicit Matcher(const FA &fa);
+
+    void feed(const char *data, size_t size);
+
+    void feed(std::string_view chunk);
+
+    // whether everything fed since the last reset is accepted
+    [[nodiscard]]
+    bool isAccepting() const;
+
+    // true once no continuation of the input can be accepted anymore
+    [[nodiscard]]
+    bool isDead() const;
+
+    // starts over with an empty input
+    void reset();
+
+private:
+    void step(Symbol symbol);
+
+    // removes the states that can not reach an accepting state from `set` and `in_set`
+    void prune(std::vector<CSRAutomaton::StateId> &set, std::vector<uint64_t> &in_set) const;
+
+private:
+    // exactly one of the two is set
+    std::shared_ptr<const CompiledDFA> dfa;
+    std::shared_ptr<const CSRAutomaton> nfa;
+
+    int32_t state = 0;
+
+    std::vector<CSRAutomaton::StateId> current;
+    std::vector<CSRAutomaton::StateId> next;
+    // bitmaps that mirror `current` and `next`
+    std::vector<uint64_t> inCurrent;
+    std::vector<uint64_t> inNext;
+};
+
+
+#endif //AUTOMATA_MATCHER_H
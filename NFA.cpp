@@ -2,8 +2,34 @@
 // Created by nilerrors on 3/6/24.
 //
 
+#include <algorithm>
 #include <deque>
+#include <unordered_map>
 #include "NFA.h"
+#include "ByteClasses.h"
+
+namespace
+{
+    // a subset of states as the sorted indices of its states, the hash is computed once
+    struct SubsetKey
+    {
+        std::vector<uint32_t> indices;
+        size_t hash = 0;
+
+        bool operator==(const SubsetKey &other) const
+        {
+            return hash == other.hash && indices == other.indices;
+        }
+    };
+
+    struct SubsetKeyHash
+    {
+        size_t operator()(const SubsetKey &key) const
+        {
+            return key.hash;
+        }
+    };
+}
 
 NFA::NFA() : FA("NFA")
 {
@@ -18,73 +44,110 @@ NFA::~NFA() = default;
 
 bool NFA::accepts(const std::string &string) const
 {
-    return toDFA().accepts(string);
+    return determinize()->accepts(string);
+}
+
+bool NFA::simulate(const std::string &string) const
+{
+    const size_t now = getRevision();
+    std::shared_ptr<const Simulation> current = std::atomic_load(&simulation);
+    if (current == nullptr || current->revision != now)
+    {
+        current = std::make_shared<const Simulation>(Simulation{now, BitsetNFA(*this)});
+        std::atomic_store(&simulation, current);
+    }
+    return current->nfa.accepts(string);
+}
+
+std::shared_ptr<const DFA> NFA::determinize() const
+{
+    const size_t now = getRevision();
+    std::shared_ptr<const Determinized> current = std::atomic_load(&determinized);
+    if (current == nullptr || current->revision != now)
+    {
+        // readers that race here build the same dfa, whichever is stored last wins
+        current = std::make_shared<const Determinized>(Determinized{now, toDFA()});
+        std::atomic_store(&determinized, current);
+    }
+    return {current, &current->dfa};
 }
 
 DFA NFA::toDFA() const
 {
-    DFA dfa;
+    DFA dfa(alphabet);
 
-    if (states.empty() || alphabet.empty() || transitions.empty())
+    // without a starting state there are no subsets, without symbols or transitions the starting subset is the only one
+    if (startingState == nullptr)
     {
         return dfa;
     }
 
+    // the subsets only live during the construction, the states they name are owned by the dfa
+    Arena scratch;
+    std::unordered_map<const State *, uint32_t> indices;
+    indices.reserve(states.size());
+    for (const std::shared_ptr<State> &state: states)
+    {
+        indices.emplace(state.get(), static_cast<uint32_t>(indices.size()));
+    }
+    auto key_of = [&indices](const SetOfStates &set) {
+        SubsetKey key;
+        key.indices.reserve(set.states.size());
+        for (const std::shared_ptr<State> &state: set.states)
+        {
+            const auto found = indices.find(state.get());
+            key.indices.push_back(found == indices.end() ? UINT32_MAX : found->second);
+        }
+        std::sort(key.indices.begin(), key.indices.end());
+        key.hash = key.indices.size();
+        for (const uint32_t index: key.indices)
+        {
+            key.hash ^= index + 0x9e3779b97f4a7c15 + (key.hash << 6) + (key.hash >> 2);
+        }
+        return key;
+    };
 
-    dfa.clear();
-    dfa.setAlphabet(alphabet);
     std::shared_ptr<SetOfStates> starting = getStartingStates();
     std::deque<std::shared_ptr<SetOfStates>> unprocessed_states = {starting};
-    std::set<std::shared_ptr<SetOfStates>> all_states = {starting};
+    std::unordered_map<SubsetKey, std::shared_ptr<SetOfStates>, SubsetKeyHash> all_states;
+    all_states.emplace(key_of(*starting), starting);
 
-    auto in_all_states = [&all_states](const std::shared_ptr<SetOfStates> &set) -> bool {
-        return std::any_of(all_states.cbegin(), all_states.cend(), [set](const std::shared_ptr<SetOfStates> &s) {
-            return s->states.size() == set->states.size() && s->to_string() == set->to_string();
-        });
-    };
+    dfa.addState(starting->to_state(dfa));
 
-    auto get_from_all_states = [&all_states](const std::string &name) -> std::shared_ptr<SetOfStates> {
-        for (const std::shared_ptr<SetOfStates> &s: all_states)
-        {
-            if (s->to_string() == name)
-            {
-                return s;
-            }
-        }
-        return nullptr;
-    };
+    const std::vector<std::vector<Symbol>> symbol_groups = ByteClasses(*this).partition(alphabet);
 
-    dfa.addState(starting->to_state());
+    // every subset is processed once, so each (subset, symbol) pair yields exactly one transition
+    std::vector<std::shared_ptr<Transition>> dfa_transitions;
 
     while (!unprocessed_states.empty())
     {
         std::shared_ptr<SetOfStates> current_state = unprocessed_states.front();
         unprocessed_states.pop_front();
 
-        if (!in_all_states(current_state))
+        for (const std::vector<Symbol> &group: symbol_groups)
         {
-            all_states.insert(current_state);
-        }
-
-        for (const Symbol symbol: alphabet)
-        {
-            std::shared_ptr<SetOfStates> next_state = getNextStates(current_state, symbol);
+            // every symbol of a group leads to the same subset
+            std::shared_ptr<SetOfStates> next_state = getNextStates(current_state, group.front(), &scratch);
 
-            if (!in_all_states(next_state))
+            const auto found = all_states.emplace(key_of(*next_state), next_state);
+            if (found.second)
             {
                 unprocessed_states.push_back(next_state);
-                all_states.insert(next_state);
-                dfa.addState(next_state->to_state());
+                dfa.addState(next_state->to_state(dfa));
             }
             else
             {
-                std::string name = next_state->to_string();
-                next_state = get_from_all_states(name);
+                next_state = found.first->second;
             }
 
-            dfa.addTransition(std::make_shared<Transition>(current_state->to_state(), next_state->to_state(), symbol));
+            for (const Symbol symbol: group)
+            {
+                dfa_transitions.push_back(
+                        dfa.newTransition(current_state->to_state(), next_state->to_state(), symbol));
+            }
         }
     }
+    dfa.addUniqueTransitions(dfa_transitions);
 
     return dfa;
 }
@@ -7,6 +7,7 @@
 
 #include "FA.h"
 #include "DFA.h"
+#include "BitsetNFA.h"
 
 
 class NFA : public FA
@@ -17,13 +18,49 @@ public:
     [[maybe_unused]]
     explicit NFA(const std::string &file_path);
 
+    NFA(const NFA &other) = default;
+
+    NFA(NFA &&other) noexcept = default;
+
     virtual ~NFA();
 
+    NFA &operator=(const NFA &other) = default;
+
+    NFA &operator=(NFA &&other) noexcept = default;
+
     [[nodiscard]]
     DFA toDFA() const;
 
+    // toDFA(), built once and rebuilt only after a mutation
+    [[nodiscard]]
+    std::shared_ptr<const DFA> determinize() const;
+
     [[nodiscard]]
     bool accepts(const std::string &string) const override;
+
+    // accepts without determinizing, for automata whose subset construction explodes.
+    // the bitset simulation is built once and rebuilt only after a mutation
+    [[nodiscard]]
+    bool simulate(const std::string &string) const;
+
+private:
+    // the dfa together with the revision it was built from, only accessed with std::atomic_load/store
+    struct Determinized
+    {
+        size_t revision;
+        DFA dfa;
+    };
+
+    mutable std::shared_ptr<const Determinized> determinized = nullptr;
+
+    // the same for the bitset simulation
+    struct Simulation
+    {
+        size_t revision;
+        BitsetNFA nfa;
+    };
+
+    mutable std::shared_ptr<const Simulation> simulation = nullptr;
 };
 
 
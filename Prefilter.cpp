@@ -0,0 +1,235 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+#include "Prefilter.h"
+
+namespace
+{
+    // the bytes that a single dominator edge can be taken on
+    std::vector<std::vector<unsigned char>> bytes_of_classes(const ByteClasses &classes)
+    {
+        std::vector<std::vector<unsigned char>> bytes(classes.size());
+        for (size_t byte = 0; byte < 256; byte++)
+        {
+            bytes[classes.getMap()[byte]].push_back(static_cast<unsigned char>(byte));
+        }
+        return bytes;
+    }
+}
+
+Prefilter::Prefilter(std::string literal) : literal(std::move(literal))
+{
+}
+
+Prefilter::Prefilter(const RE &re) : literal(re.getRequiredLiteral())
+{
+}
+
+Prefilter::Prefilter(const CompiledDFA &dfa)
+{
+    const int32_t dead = dfa.getDeadState();
+    const int32_t start = dfa.getStartingState();
+    if (start == dead)
+    {
+        return;
+    }
+    const size_t stride = dfa.getStride();
+    const std::vector<int32_t> &table = dfa.getTable();
+    // node `dead` stands for "accepted", every accepting state has an edge to it
+    const int32_t accepted = dead;
+
+    std::vector<std::vector<int32_t>> predecessors(dfa.size());
+    auto successors = [&](const int32_t state, const std::function<void(int32_t)> &visit) {
+        for (size_t byte_class = 0; byte_class < stride; byte_class++)
+        {
+            const int32_t to = table[state * stride + byte_class];
+            if (to != dead)
+            {
+                visit(to);
+            }
+        }
+        if (dfa.isAccepting(state))
+        {
+            visit(accepted);
+        }
+    };
+
+    // reverse post order of the states reachable from the start
+    std::vector<int32_t> order;
+    std::vector<int32_t> position(dfa.size(), -1);
+    std::vector<bool> seen(dfa.size(), false);
+    std::vector<std::pair<int32_t, std::vector<int32_t>>> stack;
+    seen[start] = true;
+    stack.push_back({start, {}});
+    successors(start, [&](const int32_t to) { stack.back().second.push_back(to); });
+    while (!stack.empty())
+    {
+        if (stack.back().second.empty())
+        {
+            order.push_back(stack.back().first);
+            stack.pop_back();
+            continue;
+        }
+        const int32_t from = stack.back().first;
+        const int32_t to = stack.back().second.back();
+        stack.back().second.pop_back();
+        predecessors[to].push_back(from);
+        if (!seen[to])
+        {
+            seen[to] = true;
+            stack.push_back({to, {}});
+            if (to != accepted)
+            {
+                successors(to, [&](const int32_t next) { stack.back().second.push_back(next); });
+            }
+        }
+    }
+    if (!seen[accepted])
+    {
+        return;
+    }
+    std::reverse(order.begin(), order.end());
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        position[order[i]] = static_cast<int32_t>(i);
+    }
+
+    // the iterative algorithm of Cooper, Harvey and Kennedy
+    std::vector<int32_t> idom(dfa.size(), -1);
+    idom[start] = start;
+    auto intersect = [&](int32_t a, int32_t b) {
+        while (a != b)
+        {
+            while (position[a] > position[b])
+            {
+                a = idom[a];
+            }
+            while (position[b] > position[a])
+            {
+                b = idom[b];
+            }
+        }
+        return a;
+    };
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (const int32_t state: order)
+        {
+            if (state == start)
+            {
+                continue;
+            }
+            int32_t dominator = -1;
+            for (const int32_t from: predecessors[state])
+            {
+                if (idom[from] != -1)
+                {
+                    dominator = dominator == -1 ? from : intersect(from, dominator);
+                }
+            }
+            if (dominator != idom[state])
+            {
+                idom[state] = dominator;
+                changed = true;
+            }
+        }
+    }
+
+    // the states every accepting path passes through, from the start on
+    std::vector<int32_t> chain;
+    for (int32_t state = idom[accepted]; state != start; state = idom[state])
+    {
+        chain.push_back(state);
+    }
+    chain.push_back(start);
+    std::reverse(chain.begin(), chain.end());
+
+    // a dominator that is only ever entered over one byte adds that byte to the literal,
+    // the run goes on as long as the next dominator can only be entered from this one
+    const std::vector<std::vector<unsigned char>> bytes = bytes_of_classes(dfa.getByteClasses());
+    std::string run;
+    for (size_t i = 1; i < chain.size(); i++)
+    {
+        const int32_t to = chain[i];
+        int byte = -1;
+        bool adjacent = true;
+        for (const int32_t from: predecessors[to])
+        {
+            adjacent = adjacent && from == chain[i - 1];
+            for (size_t byte_class = 0; byte_class < stride; byte_class++)
+            {
+                if (table[from * stride + byte_class] != to)
+                {
+                    continue;
+                }
+                const bool single = bytes[byte_class].size() == 1;
+                byte = single && (byte == -1 || byte == bytes[byte_class].front()) ? bytes[byte_class].front() : -2;
+            }
+        }
+        if (byte < 0)
+        {
+            run.clear();
+            continue;
+        }
+        if (!adjacent)
+        {
+            run.clear();
+        }
+        run.push_back(static_cast<char>(byte));
+        if (run.size() > literal.size())
+        {
+            literal = run;
+        }
+    }
+}
+
+bool Prefilter::mayMatch(const char *data, const size_t size) const
+{
+    return literal.empty() || find(data, size) != size;
+}
+
+size_t Prefilter::find(const char *data, const size_t size) const
+{
+    if (literal.empty())
+    {
+        return 0;
+    }
+    if (literal.size() > size)
+    {
+        return size;
+    }
+    const char first = literal.front();
+    const char *last = data + size - literal.size();
+    const char *candidate = data;
+    while (candidate <= last)
+    {
+        candidate = static_cast<const char *>(std::memchr(candidate, first, last - candidate + 1));
+        if (candidate == nullptr)
+        {
+            break;
+        }
+        if (std::memcmp(candidate + 1, literal.data() + 1, literal.size() - 1) == 0)
+        {
+            return candidate - data;
+        }
+        candidate++;
+    }
+    return size;
+}
+
+const std::string &Prefilter::getLiteral() const
+{
+    return literal;
+}
+
+Prefilter Prefilter::best(const Prefilter &a, const Prefilter &b)
+{
+    return b.literal.size() > a.literal.size() ? b : a;
+}
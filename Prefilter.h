@@ -0,0 +1,51 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#ifndef AUTOMATA_PREFILTER_H
+#define AUTOMATA_PREFILTER_H
+
+#include <string>
+
+#include "RE.h"
+#include "CompiledDFA.h"
+
+// A literal that every accepted string contains.
+// Searching for it with memchr/memcmp is much cheaper than running the automaton, so inputs that
+// do not contain it can be rejected before the automaton is touched.
+class Prefilter
+{
+public:
+    // accepts everything
+    Prefilter() = default;
+
+    explicit Prefilter(std::string literal);
+
+    // from the syntax tree of the expression
+    explicit Prefilter(const RE &re);
+
+    // from the dominators of the accepting states: states every accepting path passes through,
+    // that can each only be entered over one byte from the previous one, spell a required literal
+    explicit Prefilter(const CompiledDFA &dfa);
+
+    // false if the input can not be accepted, true if the automaton has to decide
+    [[nodiscard]]
+    bool mayMatch(const char *data, size_t size) const;
+
+    // the offset of the first occurrence of the literal, or `size` if there is none
+    [[nodiscard]]
+    size_t find(const char *data, size_t size) const;
+
+    [[nodiscard]]
+    const std::string &getLiteral() const;
+
+    // the longer literal of both
+    [[nodiscard]]
+    static Prefilter best(const Prefilter &a, const Prefilter &b);
+
+private:
+    std::string literal;
+};
+
+
+#endif //AUTOMATA_PREFILTER_H
@@ -4,6 +4,7 @@
 
 #include "RE.h"
 
+#include <algorithm>
 #include <deque>
 #include <iostream>
 #include <stack>
@@ -221,7 +222,7 @@ std::shared_ptr<ENFA> RExpression::toENFA(const Symbol epsilon) const
         std::shared_ptr<ENFA> enfa = std::make_shared<ENFA>();
         enfa->setEpsilon(epsilon);
         enfa->setAlphabet({});
-        std::shared_ptr<State> start = std::make_shared<State>("startend", true, true);
+        std::shared_ptr<State> start = enfa->newState("startend", true, true);
         enfa->addState(start);
         return enfa;
     }
@@ -230,11 +231,11 @@ std::shared_ptr<ENFA> RExpression::toENFA(const Symbol epsilon) const
         std::shared_ptr<ENFA> enfa = std::make_shared<ENFA>();
         enfa->setEpsilon(epsilon);
         enfa->setAlphabet({value.front()});
-        std::shared_ptr<State> start = std::make_shared<State>("start", true, false);
-        std::shared_ptr<State> end = std::make_shared<State>("end", false, true);
+        std::shared_ptr<State> start = enfa->newState("start", true, false);
+        std::shared_ptr<State> end = enfa->newState("end", false, true);
         enfa->addState(start);
         enfa->addState(end);
-        enfa->addTransition(std::make_shared<Transition>(start, end, value.front()));
+        enfa->addTransition(enfa->newTransition(start, end, value.front()));
         return enfa;
     }
     case STAR:
@@ -279,6 +280,167 @@ std::shared_ptr<ENFA> RExpression::toENFA(const Symbol epsilon) const
     }
 }
 
+namespace
+{
+    std::string common_prefix(const std::string &a, const std::string &b)
+    {
+        const auto mismatch = std::mismatch(a.begin(), a.end(), b.begin(), b.end());
+        return {a.begin(), mismatch.first};
+    }
+
+    std::string common_suffix(const std::string &a, const std::string &b)
+    {
+        const auto mismatch = std::mismatch(a.rbegin(), a.rend(), b.rbegin(), b.rend());
+        return {mismatch.first.base(), a.end()};
+    }
+
+    // the longest common substring, both strings are short
+    std::string common_substring(const std::string &a, const std::string &b)
+    {
+        std::string longest;
+        for (size_t begin = 0; begin < a.size(); begin++)
+        {
+            for (size_t length = longest.size() + 1; begin + length <= a.size(); length++)
+            {
+                if (b.find(a.data() + begin, 0, length) == std::string::npos)
+                {
+                    break;
+                }
+                longest = a.substr(begin, length);
+            }
+        }
+        return longest;
+    }
+
+    const std::string &longest_of(const std::string &a, const std::string &b)
+    {
+        return b.size() > a.size() ? b : a;
+    }
+}
+
+Literals RExpression::getLiterals() const
+{
+    switch (type)
+    {
+    case SYMBOL:
+        return {true, value, value, value};
+    case EPSILON:
+        return {true, "", "", ""};
+    case CONCATENATION:
+    {
+        const Literals l = left->getLiterals();
+        const Literals r = right->getLiterals();
+        Literals literals;
+        literals.exact = l.exact && r.exact;
+        literals.prefix = l.exact ? l.prefix + r.prefix : l.prefix;
+        literals.suffix = r.exact ? l.suffix + r.suffix : r.suffix;
+        literals.required = longest_of(longest_of(l.required, r.required), l.suffix + r.prefix);
+        if (literals.exact)
+        {
+            literals.required = literals.prefix;
+        }
+        return literals;
+    }
+    case UNION:
+    {
+        const Literals l = left->getLiterals();
+        const Literals r = right->getLiterals();
+        if (l.exact && r.exact && l.prefix == r.prefix)
+        {
+            return l;
+        }
+        Literals literals;
+        literals.prefix = common_prefix(l.prefix, r.prefix);
+        literals.suffix = common_suffix(l.suffix, r.suffix);
+        // every string contains the literals of one of both sides, so it contains what they share
+        literals.required = longest_of(literals.prefix, literals.suffix);
+        for (const std::string *a: {&l.prefix, &l.suffix, &l.required})
+        {
+            for (const std::string *b: {&r.prefix, &r.suffix, &r.required})
+            {
+                literals.required = longest_of(literals.required, common_substring(*a, *b));
+            }
+        }
+        return literals;
+    }
+    default:
+        // a star can repeat zero times, nothing is known about the empty language
+        return {};
+    }
+}
+
+Positions RExpression::getPositions() const
+{
+    Positions automaton;
+    const Positions self = collectPositions(automaton);
+    automaton.first = self.first;
+    automaton.last = self.last;
+    automaton.nullable = self.nullable;
+    return automaton;
+}
+
+Positions RExpression::collectPositions(Positions &automaton) const
+{
+    Positions self;
+    switch (type)
+    {
+    case SYMBOL:
+    {
+        const size_t position = automaton.symbols.size();
+        automaton.symbols.push_back(value.front());
+        automaton.follow.emplace_back();
+        self.first = self.last = {position};
+        return self;
+    }
+    case EPSILON:
+        self.nullable = true;
+        return self;
+    case CONCATENATION:
+    {
+        const Positions l = left->collectPositions(automaton);
+        const Positions r = right->collectPositions(automaton);
+        for (const size_t position: l.last)
+        {
+            automaton.follow[position].insert(r.first.begin(), r.first.end());
+        }
+        self.nullable = l.nullable && r.nullable;
+        self.first = l.first;
+        if (l.nullable)
+        {
+            self.first.insert(r.first.begin(), r.first.end());
+        }
+        self.last = r.last;
+        if (r.nullable)
+        {
+            self.last.insert(l.last.begin(), l.last.end());
+        }
+        return self;
+    }
+    case UNION:
+    {
+        self = left->collectPositions(automaton);
+        const Positions r = right->collectPositions(automaton);
+        self.nullable = self.nullable || r.nullable;
+        self.first.insert(r.first.begin(), r.first.end());
+        self.last.insert(r.last.begin(), r.last.end());
+        return self;
+    }
+    case STAR:
+    {
+        self = left->collectPositions(automaton);
+        for (const size_t position: self.last)
+        {
+            automaton.follow[position].insert(self.first.begin(), self.first.end());
+        }
+        self.nullable = true;
+        return self;
+    }
+    default:
+        // the empty language has no positions and is not nullable
+        return self;
+    }
+}
+
 // Throws an exception if the regex is invalid
 RE::RE(std::string regex, const Symbol epsilon) : regex(std::move(regex)), epsilon(epsilon)
 {
@@ -292,16 +454,22 @@ RE::~RE() = default;
 
 ENFA RE::toENFA() const
 {
-    ENFA enfa;
-    enfa.setEpsilon(epsilon);
-    enfa.setAlphabet(getAlphabet(regex, epsilon));
-
     RExpression re = RExpression(regex, epsilon);
 
     std::shared_ptr<ENFA> temp = re.toENFA(epsilon);
     temp->optimizeAccept();
-    enfa = *temp;
-    return enfa;
+    // temp is not shared, its states and transitions are handed over as they are
+    return std::move(*temp);
+}
+
+std::string RE::getRequiredLiteral() const
+{
+    return RExpression(regex, epsilon).getLiterals().required;
+}
+
+Positions RE::getPositions() const
+{
+    return RExpression(regex, epsilon).getPositions();
 }
 
 std::set<Symbol> RE::getAlphabet(const std::string &regex, const Symbol epsilon)
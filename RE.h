@@ -21,6 +21,30 @@ enum RExpressionType
     EPSILON,                  // epsilon,					ε
 };
 
+// What every string of a regular expression is known to contain
+struct Literals
+{
+    // the language is exactly {prefix}, prefix == suffix == required
+    bool exact = false;
+    std::string prefix;
+    std::string suffix;
+    // a substring of every string in the language
+    std::string required;
+};
+
+// The position (Glushkov) automaton of a regular expression: one position per symbol occurrence,
+// every transition into a position is labelled with its symbol
+struct Positions
+{
+    std::vector<Symbol> symbols;
+    // the positions that can directly follow each position
+    std::vector<std::set<size_t>> follow;
+    std::set<size_t> first;
+    std::set<size_t> last;
+    // whether the empty string is accepted
+    bool nullable = false;
+};
+
 class RExpression
 {
 public:
@@ -34,6 +58,14 @@ public:
 
     [[nodiscard]] std::shared_ptr<ENFA> toENFA(Symbol epsilon) const;
 
+    [[nodiscard]] Literals getLiterals() const;
+
+    [[nodiscard]] Positions getPositions() const;
+
+private:
+    // adds the positions of this subexpression to `automaton`, returns its first, last and nullable
+    Positions collectPositions(Positions &automaton) const;
+
 private:
     RExpressionType type = EMPTY;
     std::string value;
@@ -51,6 +83,11 @@ public:
 
     [[nodiscard]] ENFA toENFA() const;
 
+    // the longest literal found that every accepted string contains, may be empty
+    [[nodiscard]] std::string getRequiredLiteral() const;
+
+    [[nodiscard]] Positions getPositions() const;
+
     static bool isValid(const std::string &regex);
 
     static std::set<Symbol> getAlphabet(const std::string &regex, Symbol epsilon);
@@ -0,0 +1,343 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#include <algorithm>
+#include <map>
+
+#include "Searcher.h"
+#include "DFA.h"
+#include "NFA.h"
+#include "ENFA.h"
+
+namespace
+{
+    using Subset = std::vector<int32_t>;
+
+    CompiledDFA compile(const FA &fa)
+    {
+        if (const auto *dfa = dynamic_cast<const DFA *>(&fa))
+        {
+            return CompiledDFA(*dfa);
+        }
+        if (const auto *nfa = dynamic_cast<const NFA *>(&fa))
+        {
+            return CompiledDFA(nfa->toDFA());
+        }
+        throw std::runtime_error("Cannot search with an automaton of type '" + fa.getType() + "'");
+    }
+
+    // subset construction over the states of `dfa`, `step` returns the sorted successor of a subset
+    // for a byte class, the empty subset becomes the dead state
+    template<typename Step, typename Accepting>
+    CompiledDFA determinize(const CompiledDFA &dfa, const Subset &initial, Step step, Accepting accepting)
+    {
+        const size_t stride = dfa.getStride();
+        std::map<Subset, int32_t> ids;
+        std::vector<Subset> subsets;
+        auto id_of = [&ids, &subsets](const Subset &subset) -> int32_t {
+            if (subset.empty())
+            {
+                return -1;
+            }
+            auto found = ids.emplace(subset, static_cast<int32_t>(subsets.size()));
+            if (found.second)
+            {
+                subsets.push_back(subset);
+            }
+            return found.first->second;
+        };
+
+        const int32_t start = id_of(initial);
+        std::vector<int32_t> table;
+        for (size_t id = 0; id < subsets.size(); id++)
+        {
+            const Subset subset = subsets[id];
+            for (size_t byte_class = 0; byte_class < stride; byte_class++)
+            {
+                table.push_back(id_of(step(subset, byte_class)));
+            }
+        }
+
+        const auto dead = static_cast<int32_t>(subsets.size());
+        for (int32_t &next: table)
+        {
+            if (next == -1)
+            {
+                next = dead;
+            }
+        }
+        table.insert(table.end(), stride, dead);
+
+        std::vector<uint64_t> accepting_bits((subsets.size() + 1 + 63) / 64, 0);
+        for (size_t id = 0; id < subsets.size(); id++)
+        {
+            if (accepting(subsets[id]))
+            {
+                accepting_bits[id / 64] |= uint64_t(1) << (id % 64);
+            }
+        }
+        return {dfa.getByteClasses(), std::move(table), std::move(accepting_bits), start == -1 ? dead : start};
+    }
+
+    void normalize(Subset &subset)
+    {
+        std::sort(subset.begin(), subset.end());
+        subset.erase(std::unique(subset.begin(), subset.end()), subset.end());
+    }
+
+    // Σ*R: every step may also start a new match
+    CompiledDFA searchForward(const CompiledDFA &dfa)
+    {
+        const int32_t dead = dfa.getDeadState();
+        const size_t stride = dfa.getStride();
+        Subset initial;
+        if (dfa.getStartingState() != dead)
+        {
+            initial.push_back(dfa.getStartingState());
+        }
+        return determinize(dfa, initial, [&](const Subset &subset, const size_t byte_class) {
+            Subset next = initial;
+            for (const int32_t state: subset)
+            {
+                const int32_t to = dfa.getTable()[state * stride + byte_class];
+                if (to != dead)
+                {
+                    next.push_back(to);
+                }
+            }
+            normalize(next);
+            return next;
+        }, [&dfa](const Subset &subset) {
+            return std::any_of(subset.begin(), subset.end(), [&dfa](const int32_t s) { return dfa.isAccepting(s); });
+        });
+    }
+
+    // Σ*rev(R): the reversed transitions, every step may also end a new match
+    CompiledDFA searchReverse(const CompiledDFA &dfa)
+    {
+        const int32_t dead = dfa.getDeadState();
+        const size_t stride = dfa.getStride();
+
+        std::vector<std::vector<int32_t>> predecessors(dfa.size() * stride);
+        Subset accepting;
+        for (int32_t from = 0; from < dead; from++)
+        {
+            for (size_t byte_class = 0; byte_class < stride; byte_class++)
+            {
+                const int32_t to = dfa.getTable()[from * stride + byte_class];
+                if (to != dead)
+                {
+                    predecessors[to * stride + byte_class].push_back(from);
+                }
+            }
+            if (dfa.isAccepting(from))
+            {
+                accepting.push_back(from);
+            }
+        }
+
+        const int32_t start = dfa.getStartingState();
+        return determinize(dfa, accepting, [&](const Subset &subset, const size_t byte_class) {
+            Subset next = accepting;
+            for (const int32_t state: subset)
+            {
+                const std::vector<int32_t> &from = predecessors[state * stride + byte_class];
+                next.insert(next.end(), from.begin(), from.end());
+            }
+            normalize(next);
+            return next;
+        }, [start](const Subset &subset) {
+            return std::binary_search(subset.begin(), subset.end(), start);
+        });
+    }
+
+    bool test(const std::vector<uint64_t> &bits, const size_t index)
+    {
+        return (bits[index / 64] >> (index % 64)) & 1;
+    }
+}
+
+Searcher::Searcher(const FA &fa) : Searcher(compile(fa))
+{
+}
+
+Searcher::Searcher(const RE &re) : Searcher(re.toENFA())
+{
+    // the syntax tree and the dominators do not always find the same literal
+    prefilter = Prefilter::best(prefilter, Prefilter(re));
+}
+
+Searcher::Searcher(const CompiledDFA &anchored)
+        : anchored(anchored), forward(searchForward(anchored)), reverse(searchReverse(anchored)),
+          prefilter(anchored)
+{
+}
+
+bool Searcher::contains(const std::string &text) const
+{
+    return contains(text.data(), text.size());
+}
+
+bool Searcher::contains(const char *data, const size_t size) const
+{
+    if (!prefilter.mayMatch(data, size))
+    {
+        return false;
+    }
+    int32_t state = forward.getStartingState();
+    if (forward.isAccepting(state))
+    {
+        return true;
+    }
+    for (size_t i = 0; i < size; i++)
+    {
+        state = forward.getNextState(state, data[i]);
+        if (forward.isAccepting(state))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::optional<Searcher::Match> Searcher::find(const std::string &text) const
+{
+    return find(text.data(), text.size());
+}
+
+std::optional<Searcher::Match> Searcher::find(const char *data, const size_t size) const
+{
+    const std::optional<size_t> limit = lastEnd(data, size);
+    if (!limit)
+    {
+        return std::nullopt;
+    }
+    const std::vector<uint64_t> match_starts = starts(data, size);
+    for (size_t begin = 0; begin <= *limit; begin++)
+    {
+        if (test(match_starts, begin))
+        {
+            return Match{begin, *longest(data, begin, *limit)};
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<Searcher::Match> Searcher::findAll(const std::string &text) const
+{
+    return findAll(text.data(), text.size());
+}
+
+std::vector<Searcher::Match> Searcher::findAll(const char *data, const size_t size) const
+{
+    std::vector<Match> matches;
+    const std::optional<size_t> limit = lastEnd(data, size);
+    if (!limit)
+    {
+        return matches;
+    }
+    const std::vector<uint64_t> match_starts = starts(data, size);
+    size_t begin = 0;
+    while (begin <= *limit)
+    {
+        if (!test(match_starts, begin))
+        {
+            begin++;
+            continue;
+        }
+        const size_t end = *longest(data, begin, *limit);
+        matches.push_back({begin, end});
+        // the next search resumes at the end of this match, an empty match does not consume anything
+        begin = end == begin ? end + 1 : end;
+    }
+    return matches;
+}
+
+const CompiledDFA &Searcher::getAnchored() const
+{
+    return anchored;
+}
+
+const CompiledDFA &Searcher::getForward() const
+{
+    return forward;
+}
+
+const CompiledDFA &Searcher::getReverse() const
+{
+    return reverse;
+}
+
+const Prefilter &Searcher::getPrefilter() const
+{
+    return prefilter;
+}
+
+std::vector<uint64_t> Searcher::starts(const char *data, const size_t size) const
+{
+    std::vector<uint64_t> bits((size + 1 + 63) / 64, 0);
+    int32_t state = reverse.getStartingState();
+    size_t i = size;
+    while (true)
+    {
+        if (reverse.isAccepting(state))
+        {
+            bits[i / 64] |= uint64_t(1) << (i % 64);
+        }
+        if (i == 0 || state == reverse.getDeadState())
+        {
+            break;
+        }
+        i--;
+        state = reverse.getNextState(state, data[i]);
+    }
+    return bits;
+}
+
+std::optional<size_t> Searcher::lastEnd(const char *data, const size_t size) const
+{
+    if (!prefilter.mayMatch(data, size))
+    {
+        return std::nullopt;
+    }
+    std::optional<size_t> end;
+    int32_t state = forward.getStartingState();
+    for (size_t i = 0;; i++)
+    {
+        if (forward.isAccepting(state))
+        {
+            end = i;
+        }
+        if (i == size)
+        {
+            break;
+        }
+        state = forward.getNextState(state, data[i]);
+    }
+    return end;
+}
+
+std::optional<size_t> Searcher::longest(const char *data, const size_t begin, const size_t limit) const
+{
+    std::optional<size_t> end;
+    int32_t state = anchored.getStartingState();
+    for (size_t i = begin; state != anchored.getDeadState(); i++)
+    {
+        if (anchored.isAccepting(state))
+        {
+            end = i;
+        }
+        if (state == anchored.getAcceptSink())
+        {
+            // every longer span is accepted as well, and no match ends after `limit`
+            return limit;
+        }
+        if (i == limit)
+        {
+            break;
+        }
+        state = anchored.getNextState(state, data[i]);
+    }
+    return end;
+}
@@ -0,0 +1,107 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#ifndef AUTOMATA_SEARCHER_H
+#define AUTOMATA_SEARCHER_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "FA.h"
+#include "RE.h"
+#include "CompiledDFA.h"
+#include "Prefilter.h"
+
+// Finds the substrings of a text that an automaton accepts, in a single pass per question.
+// Three tables are derived from the (determinized) automaton R:
+// - R itself, anchored, to extend a match from a known start to its longest end
+// - Σ*R, which is accepting right after the end of every match, to answer contains()
+// - Σ*rev(R), which is run backwards over the text and is accepting at the start of every match
+// Texts without the literal that every match contains are rejected before any table is run.
+class Searcher
+{
+public:
+    // the half open span [begin, end) of a match
+    struct Match
+    {
+        size_t begin = 0;
+        size_t end = 0;
+
+        bool operator==(const Match &other) const
+        {
+            return begin == other.begin && end == other.end;
+        }
+
+        bool operator!=(const Match &other) const
+        {
+            return !(*this == other);
+        }
+    };
+
+    explicit Searcher(const FA &fa);
+
+    explicit Searcher(const RE &re);
+
+    // whether some substring is accepted, stops at the end of the first match
+    [[nodiscard]]
+    bool contains(const std::string &text) const;
+
+    [[nodiscard]]
+    bool contains(const char *data, size_t size) const;
+
+    // the leftmost-longest match
+    [[nodiscard]]
+    std::optional<Match> find(const std::string &text) const;
+
+    [[nodiscard]]
+    std::optional<Match> find(const char *data, size_t size) const;
+
+    // every leftmost-longest match, left to right, without overlaps.
+    // Each search resumes at the end of the previous match and no match is extended past the end of the
+    // last match in the text, so the usual cost is linear. The worst case is still O(n^2): in a+a*b over
+    // a long run of a's, every one byte match is first extended to the end of the run looking for a b
+    [[nodiscard]]
+    std::vector<Match> findAll(const std::string &text) const;
+
+    [[nodiscard]]
+    std::vector<Match> findAll(const char *data, size_t size) const;
+
+    [[nodiscard]]
+    const CompiledDFA &getAnchored() const;
+
+    [[nodiscard]]
+    const CompiledDFA &getForward() const;
+
+    [[nodiscard]]
+    const CompiledDFA &getReverse() const;
+
+    [[nodiscard]]
+    const Prefilter &getPrefilter() const;
+
+private:
+    explicit Searcher(const CompiledDFA &anchored);
+
+    // bit i is set if a match starts at offset i, for i in [0, size]
+    [[nodiscard]]
+    std::vector<uint64_t> starts(const char *data, size_t size) const;
+
+    // the end of the last match in the text, one forward pass
+    [[nodiscard]]
+    std::optional<size_t> lastEnd(const char *data, size_t size) const;
+
+    // the end of the longest match that starts at `begin` and ends at or before `limit`, if there is one
+    [[nodiscard]]
+    std::optional<size_t> longest(const char *data, size_t begin, size_t limit) const;
+
+private:
+    CompiledDFA anchored;
+    CompiledDFA forward;
+    CompiledDFA reverse;
+    Prefilter prefilter;
+};
+
+
+#endif //AUTOMATA_SEARCHER_H
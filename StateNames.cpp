@@ -0,0 +1,117 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "StateNames.h"
+
+StateNames::Entry::Entry(std::string name, const Naming naming, std::vector<Part> parts)
+        : naming(naming), name(std::move(name)), parts(std::move(parts)),
+          named(naming == Naming::GIVEN)
+{
+}
+
+StateNames::Id StateNames::add(std::string name)
+{
+    if (entries.size() >= UINT32_MAX)
+    {
+        throw std::runtime_error("too many states");
+    }
+    entries.emplace_back(std::move(name), Naming::GIVEN, std::vector<Part>());
+    return static_cast<Id>(entries.size() - 1);
+}
+
+StateNames::Id StateNames::add(const Naming naming, std::vector<Part> parts, std::string prefix)
+{
+    if (entries.size() >= UINT32_MAX)
+    {
+        throw std::runtime_error("too many states");
+    }
+    for (const Part &part: parts)
+    {
+        // a table never keeps itself alive
+        if (part.names == this)
+        {
+            continue;
+        }
+        if (std::none_of(sources.begin(), sources.end(), [&part](const std::shared_ptr<const StateNames> &source) {
+            return source.get() == part.names;
+        }))
+        {
+            sources.push_back(part.names->shared_from_this());
+        }
+    }
+    // only a PREFIXED name starts with something
+    entries.emplace_back(naming == Naming::PREFIXED ? std::move(prefix) : std::string(), naming, std::move(parts));
+    return static_cast<Id>(entries.size() - 1);
+}
+
+const std::string &StateNames::get(const Id id) const
+{
+    const Entry &entry = entries[id];
+    if (!entry.named.load(std::memory_order_acquire))
+    {
+        std::call_once(entry.built, [this, &entry]() { build(entry); });
+    }
+    return entry.name;
+}
+
+bool StateNames::isNamed(const Id id) const
+{
+    return entries[id].named.load(std::memory_order_acquire);
+}
+
+size_t StateNames::size() const
+{
+    return entries.size();
+}
+
+std::string StateNames::setName(std::vector<std::string_view> names)
+{
+    std::sort(names.begin(), names.end());
+    std::string name = "{";
+    for (const std::string_view part_name: names)
+    {
+        if (name.size() != 1)
+        {
+            name += ",";
+        }
+        name += part_name;
+    }
+    name += "}";
+    return name;
+}
+
+void StateNames::build(const Entry &entry) const
+{
+    switch (entry.naming)
+    {
+    case Naming::SET:
+    {
+        std::vector<std::string_view> all_names;
+        all_names.reserve(entry.parts.size());
+        for (const Part &part: entry.parts)
+        {
+            all_names.emplace_back(part.names->get(part.id));
+        }
+        entry.name = setName(std::move(all_names));
+        break;
+    }
+    case Naming::PAIR:
+        entry.name = "(" + entry.parts[0].names->get(entry.parts[0].id) + ","
+                     + entry.parts[1].names->get(entry.parts[1].id) + ")";
+        break;
+    case Naming::PREFIXED:
+        entry.name += entry.parts[0].names->get(entry.parts[0].id);
+        break;
+    default:
+        break;
+    }
+
+    // the parts are only needed for the name
+    entry.parts.clear();
+    entry.parts.shrink_to_fit();
+    entry.named.store(true, std::memory_order_release);
+}
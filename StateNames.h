@@ -0,0 +1,85 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#ifndef AUTOMATA_STATENAMES_H
+#define AUTOMATA_STATENAMES_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// how the name of a state is obtained, derived states build it from their parts only when it is asked for
+enum class Naming : uint8_t
+{
+    GIVEN,                  // the name was given on construction
+    SET,                    // {a,b,c}, the sorted names of the parts
+    PAIR,                   // (a,b)
+    PREFIXED,               // the prefix followed by the name of the single part
+};
+
+// The names of the states of one automaton, a state is an index into the table of its automaton.
+// A derived state (a subset, a pair, a renamed copy) only records its tag and the ids of its parts in the
+// tables of the automata it was built from, its name is built the first time it is asked for.
+// A table keeps the tables of those automata alive, but not the automata or their states.
+// Adding is not thread safe, building names is.
+class StateNames : public std::enable_shared_from_this<StateNames>
+{
+public:
+    using Id = uint32_t;
+
+    // a state of the automaton that owns `names`
+    struct Part
+    {
+        const StateNames *names;
+        Id id;
+    };
+
+    Id add(std::string name);
+
+    Id add(Naming naming, std::vector<Part> parts, std::string prefix = "");
+
+    [[nodiscard]]
+    const std::string &get(Id id) const;
+
+    // whether the name is given or has already been built
+    [[nodiscard]]
+    bool isNamed(Id id) const;
+
+    [[nodiscard]]
+    size_t size() const;
+
+    // {a,b,c}
+    [[nodiscard]]
+    static std::string setName(std::vector<std::string_view> names);
+
+private:
+    struct Entry
+    {
+        Naming naming;
+        // holds the prefix of a PREFIXED name until it is built
+        mutable std::string name;
+        // dropped once the name is built
+        mutable std::vector<Part> parts;
+        mutable std::once_flag built;
+        mutable std::atomic<bool> named;
+
+        Entry(std::string name, Naming naming, std::vector<Part> parts);
+    };
+
+    void build(const Entry &entry) const;
+
+private:
+    // entries are never moved, so references to names stay valid while the table grows
+    std::deque<Entry> entries;
+    std::vector<std::shared_ptr<const StateNames>> sources;
+};
+
+
+#endif //AUTOMATA_STATENAMES_H
@@ -6,6 +6,7 @@
 #include "StatesTable.h"
 #include "FA.h"
 #include "DFA.h"
+#include "ByteClasses.h"
 
 StatesTable::StatesTable() = default;
 
@@ -22,7 +23,7 @@ void StatesTable::from(const DFA *dfa)
     }
 
     std::sort(fa_states.begin(), fa_states.end(),
-              [](const std::shared_ptr<State> &a, const std::shared_ptr<State> &b) { return a->name < b->name; });
+              [](const std::shared_ptr<State> &a, const std::shared_ptr<State> &b) { return a->getName() < b->getName(); });
 
     for (const std::shared_ptr<State> &state: fa_states)
     {
@@ -40,7 +41,7 @@ void StatesTable::from(const DFA *dfa)
     {
         for (std::shared_ptr<State> &col: cols)
         {
-            if (row == col || row->name < col->name
+            if (row == col || row->getName() < col->getName()
                 || std::any_of(table.begin(), table.end(), [&](const StateEquivalence &eqv) -> bool {
                 return (eqv.first == row && eqv.second == col) || (eqv.first == col && eqv.second == row);
             }))
@@ -64,6 +65,13 @@ void StatesTable::fill()
         }
     }
 
+    // symbols of one byte class lead to the same states, one representative per class is enough
+    std::vector<Symbol> symbols;
+    for (const std::vector<Symbol> &group: ByteClasses(*fa).partition(fa->getAlphabet()))
+    {
+        symbols.push_back(group.front());
+    }
+
     bool changed = true;
     while (changed)
     {
@@ -72,7 +80,7 @@ void StatesTable::fill()
         {
             if (!eqv.is_distinguishable && !eqv.unresolvable)
             {
-                for (Symbol symbol: fa->getAlphabet())
+                for (Symbol symbol: symbols)
                 {
                     std::shared_ptr<State> next_first = fa->getTransitionFromStateBySymbol(eqv.first, symbol)->to;
                     std::shared_ptr<State> next_second = fa->getTransitionFromStateBySymbol(eqv.second, symbol)->to;
@@ -102,7 +110,7 @@ std::string StatesTable::to_string() const
             {
                 result << std::endl;
             }
-            result << eqv.first->name;
+            result << eqv.first->getName();
         }
 
         row = eqv.first;
@@ -120,7 +128,7 @@ std::string StatesTable::to_string() const
     result << std::endl;
     for (const std::shared_ptr<State> &col: cols)
     {
-        result << "\t" << col->name;
+        result << "\t" << col->getName();
     }
 
     return result.str();
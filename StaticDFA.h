@@ -0,0 +1,269 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#ifndef AUTOMATA_STATICDFA_H
+#define AUTOMATA_STATICDFA_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+// A DFA for a regex that is known at compile time, built entirely in constexpr code:
+//     static constexpr auto dfa = makeStaticDFA("(a+b)*abb", 'e');
+//     static_assert(dfa.accepts("babb"));
+// The dialect is the one of RE: `+` is union, `*` is the kleene star, parentheses group and
+// `epsilon` is the empty string. Like RE, a `*` that does not follow a group stars the whole
+// concatenation before it, so "ab*" accepts "" and "abab" but not "abb".
+// The regex is turned into its Glushkov automaton, one state per symbol occurrence, which is then
+// determinized by the subset construction. Every array has a fixed size, so nothing is allocated and a
+// static constexpr instance is placed in read only data. Regexes with more than 64 symbol occurrences or
+// more than MaxStates states do not compile.
+template<size_t Length, size_t MaxStates>
+class StaticDFA
+{
+public:
+    using StateType = std::conditional_t<MaxStates < UINT8_MAX, uint8_t, uint16_t>;
+
+    constexpr StaticDFA(const char *regex, const char epsilon)
+    {
+        Glushkov glushkov{regex, epsilon};
+        glushkov.parse();
+
+        // byte class 0 holds every byte that does not occur in the regex
+        std::array<uint64_t, Length + 1> positions{};
+        size_t symbols = 0;
+        for (size_t p = 0; p < glushkov.positions; p++)
+        {
+            const auto byte = static_cast<unsigned char>(glushkov.symbols[p]);
+            if (classes[byte] == 0)
+            {
+                classes[byte] = ++symbols;
+            }
+            positions[classes[byte]] |= uint64_t(1) << p;
+        }
+
+        // state 0 is dead and state 1 is the start, the other states are sets of positions
+        std::array<uint64_t, MaxStates + 1> subsets{};
+        count = 2;
+        for (size_t state = 1; state < count; state++)
+        {
+            uint64_t follow = glushkov.first;
+            if (state != 1)
+            {
+                follow = 0;
+                for (size_t p = 0; p < glushkov.positions; p++)
+                {
+                    if ((subsets[state] >> p) & 1)
+                    {
+                        follow |= glushkov.follow[p];
+                    }
+                }
+            }
+            accepting[state] = state == 1 ? glushkov.nullable : (subsets[state] & glushkov.last) != 0;
+
+            for (size_t symbol = 1; symbol <= symbols; symbol++)
+            {
+                const uint64_t next = follow & positions[symbol];
+                if (next == 0)
+                {
+                    continue;
+                }
+                size_t to = 2;
+                while (to < count && subsets[to] != next)
+                {
+                    to++;
+                }
+                if (to == count)
+                {
+                    if (count > MaxStates)
+                    {
+                        throw std::runtime_error("Regex needs more states than MaxStates");
+                    }
+                    subsets[count++] = next;
+                }
+                table[state][symbol] = static_cast<StateType>(to);
+            }
+        }
+    }
+
+    [[nodiscard]]
+    constexpr bool accepts(const char *data, const size_t size) const
+    {
+        size_t state = 1;
+        for (size_t i = 0; i < size; i++)
+        {
+            state = table[state][classes[static_cast<unsigned char>(data[i])]];
+            if (state == 0)
+            {
+                return false;
+            }
+        }
+        return accepting[state];
+    }
+
+    [[nodiscard]]
+    constexpr bool accepts(const std::string_view string) const
+    {
+        return accepts(string.data(), string.size());
+    }
+
+    // the number of states, the dead state included
+    [[nodiscard]]
+    constexpr size_t size() const
+    {
+        return count;
+    }
+
+private:
+    // the position automaton, built by recursive descent over the regex
+    struct Glushkov
+    {
+        // nullable, first and last of a subexpression
+        struct Sub
+        {
+            bool nullable = false;
+            uint64_t first = 0;
+            uint64_t last = 0;
+        };
+
+        const char *regex;
+        char epsilon;
+        size_t index = 0;
+
+        size_t positions = 0;
+        std::array<char, 64> symbols{};
+        std::array<uint64_t, 64> follow{};
+        bool nullable = false;
+        uint64_t first = 0;
+        uint64_t last = 0;
+
+        constexpr void parse()
+        {
+            // the empty regex is the empty language
+            if (regex[0] == '\0')
+            {
+                return;
+            }
+            const Sub sub = parseUnion();
+            if (regex[index] != '\0')
+            {
+                throw std::runtime_error("Invalid regex");
+            }
+            nullable = sub.nullable;
+            first = sub.first;
+            last = sub.last;
+        }
+
+        constexpr Sub parseUnion()
+        {
+            Sub sub = parseConcatenation();
+            while (regex[index] == '+')
+            {
+                index++;
+                const Sub right = parseConcatenation();
+                sub = {sub.nullable || right.nullable, sub.first | right.first, sub.last | right.last};
+            }
+            return sub;
+        }
+
+        // as in RE, a `*` right after a group applies to the group, any other `*` to the whole
+        // concatenation before it: ab* is (ab)*, a(b)* is a(b)*
+        constexpr Sub parseConcatenation()
+        {
+            if (regex[index] == '\0' || regex[index] == '+' || regex[index] == ')' || regex[index] == '*')
+            {
+                throw std::runtime_error("Invalid regex");
+            }
+            Sub sub{true, 0, 0};
+            while (regex[index] != '\0' && regex[index] != '+' && regex[index] != ')')
+            {
+                if (regex[index] == '*')
+                {
+                    index++;
+                    star(sub);
+                    continue;
+                }
+                const bool group = regex[index] == '(';
+                Sub right = parseAtom();
+                if (group && regex[index] == '*')
+                {
+                    index++;
+                    star(right);
+                }
+                link(sub.last, right.first);
+                sub = {sub.nullable && right.nullable,
+                       sub.first | (sub.nullable ? right.first : 0),
+                       right.last | (right.nullable ? sub.last : 0)};
+            }
+            return sub;
+        }
+
+        constexpr void star(Sub &sub)
+        {
+            link(sub.last, sub.first);
+            sub.nullable = true;
+        }
+
+        constexpr Sub parseAtom()
+        {
+            const char c = regex[index++];
+            if (c == '(')
+            {
+                // () is the empty language
+                Sub sub{};
+                if (regex[index] != ')')
+                {
+                    sub = parseUnion();
+                }
+                if (regex[index++] != ')')
+                {
+                    throw std::runtime_error("Invalid regex");
+                }
+                return sub;
+            }
+            if (c == epsilon)
+            {
+                return {true, 0, 0};
+            }
+            if (positions == symbols.size())
+            {
+                throw std::runtime_error("Regex has more than 64 symbols");
+            }
+            symbols[positions] = c;
+            const uint64_t position = uint64_t(1) << positions++;
+            return {false, position, position};
+        }
+
+        // every position in `from` can be followed by every position in `to`
+        constexpr void link(const uint64_t from, const uint64_t to)
+        {
+            for (size_t p = 0; p < positions; p++)
+            {
+                if ((from >> p) & 1)
+                {
+                    follow[p] |= to;
+                }
+            }
+        }
+    };
+
+    std::array<uint8_t, 256> classes{};
+    // row 0 is the dead state, column 0 the bytes outside the regex
+    std::array<std::array<StateType, Length + 1>, MaxStates + 1> table{};
+    std::array<bool, MaxStates + 1> accepting{};
+    size_t count = 0;
+};
+
+// Length is taken from the string literal, a regex of n characters has at most n symbols
+template<size_t MaxStates = 64, size_t N>
+constexpr StaticDFA<N - 1, MaxStates> makeStaticDFA(const char (&regex)[N], const char epsilon)
+{
+    return StaticDFA<N - 1, MaxStates>(regex, epsilon);
+}
+
+
+#endif //AUTOMATA_STATICDFA_H
@@ -0,0 +1,109 @@
+//
+// Created by nilerrors on 10/17/26.
+//
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "DFA.h"
+
+using namespace std;
+
+// usage: AutomataBenchmark [states] [inputs] [input length]
+// matches random inputs against a random DFA with every matcher and prints the time per byte
+
+namespace
+{
+    DFA randomDFA(const size_t size, mt19937 &random)
+    {
+        const set<Symbol> alphabet = {'a', 'b', 'c', 'd'};
+        DFA dfa(alphabet);
+        vector<shared_ptr<State>> states;
+        for (size_t i = 0; i < size; i++)
+        {
+            states.push_back(dfa.newState("q" + to_string(i), i == 0, random() % 2 == 0));
+            dfa.addState(states.back());
+        }
+        vector<shared_ptr<Transition>> transitions;
+        for (const shared_ptr<State> &state: states)
+        {
+            for (const Symbol symbol: alphabet)
+            {
+                transitions.push_back(dfa.newTransition(state, states[random() % size], symbol));
+            }
+        }
+        dfa.addUniqueTransitions(transitions);
+        return dfa;
+    }
+
+    template<typename F>
+    void measure(const string &name, const size_t bytes, F &&f)
+    {
+        const auto start = chrono::steady_clock::now();
+        const size_t accepted = f();
+        const chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+        cout << name << ": " << elapsed.count() / 1e6 << "ms, " << elapsed.count() / bytes << "ns/byte, "
+             << accepted << " accepted" << endl;
+    }
+
+    size_t popcount(const vector<uint64_t> &bits)
+    {
+        size_t count = 0;
+        for (const uint64_t word: bits)
+        {
+            count += __builtin_popcountll(word);
+        }
+        return count;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const size_t size = argc > 1 ? stoul(argv[1]) : 100000;
+    const size_t count = argc > 2 ? stoul(argv[2]) : 200000;
+    const size_t length = argc > 3 ? stoul(argv[3]) : 64;
+
+    mt19937 random(42);
+    const DFA dfa = randomDFA(size, random);
+    shared_ptr<const CompiledDFA> compiled = dfa.compile();
+
+    vector<string> inputs(count);
+    size_t bytes = 0;
+    for (string &input: inputs)
+    {
+        input.resize(length / 2 + random() % (length + 1));
+        for (char &c: input)
+        {
+            c = static_cast<char>('a' + random() % 4);
+        }
+        bytes += input.size();
+    }
+    const vector<string_view> views(inputs.begin(), inputs.end());
+
+    cout << size << " states, " << count << " inputs, " << bytes << " bytes" << endl;
+    measure("accepts", bytes, [&]() {
+        size_t accepted = 0;
+        for (const string &input: inputs)
+        {
+            accepted += compiled->accepts(input);
+        }
+        return accepted;
+    });
+    measure("acceptsMany (scalar)", bytes, [&]() {
+        return popcount(compiled->acceptsMany(views.data(), views.size(), CompiledDFA::Kernel::SCALAR));
+    });
+    if (CompiledDFA::getBestKernel() == CompiledDFA::Kernel::AVX2)
+    {
+        measure("acceptsMany (avx2)", bytes, [&]() {
+            return popcount(compiled->acceptsMany(views.data(), views.size(), CompiledDFA::Kernel::AVX2));
+        });
+    }
+    else
+    {
+        cout << "acceptsMany (avx2): not supported on this cpu" << endl;
+    }
+    return 0;
+}
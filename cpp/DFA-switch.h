@@ -0,0 +1,38 @@
+// generated from a 2 state DFA by DFA::to_cpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+inline bool dfa_switch(const char *data, std::size_t size)
+{
+    const char *end = data + size;
+s0:
+    if (data == end)
+    {
+        return false;
+    }
+    switch (static_cast<unsigned char>(*data++))
+    {
+    case '0':
+        goto s0;
+    case '1':
+        goto s1;
+    default:
+        return false;
+    }
+s1:
+    if (data == end)
+    {
+        return true;
+    }
+    switch (static_cast<unsigned char>(*data++))
+    {
+    case '1':
+        goto s0;
+    case '0':
+        goto s1;
+    default:
+        return false;
+    }
+}
@@ -1,12 +1,27 @@
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <thread>
+#include <filesystem>
 
 #include "DFA.h"
 #include "NFA.h"
 #include "ENFA.h"
 #include "json.hpp"
 #include "RE.h"
+#include "ByteClasses.h"
+#include "CSRAutomaton.h"
+#include "FrozenFA.h"
+#include "LiveFA.h"
+#include "Matcher.h"
+#include "FileScanner.h"
+#include "Searcher.h"
+#include "Prefilter.h"
+#include "StaticDFA.h"
+#include "BitParallelNFA.h"
+#include "LazyDFA.h"
+#include "cpp/DFA-table.h"
+#include "cpp/DFA-switch.h"
 
 using namespace std;
 using json = nlohmann::json;
@@ -14,8 +29,36 @@ using json = nlohmann::json;
 
 void testDFA();
 
+void testCompiledDFA();
+
+void testToCpp();
+
+void testStaticDFA();
+
+void testByteClasses();
+
+void testMoves();
+
+void testCSRAutomaton();
+
 void testNFA();
 
+void testBitsetNFA();
+
+void testBitParallelNFA();
+
+void testLazyDFA();
+
+void testLiveFA();
+
+void testMatcher();
+
+void testFileScanner();
+
+void testSearcher();
+
+void testPrefilter();
+
 void testENFA();
 
 void testProduct();
@@ -28,19 +71,71 @@ void testRE2();
 
 bool compareSrcJSON(const string &src, json j2);
 
+NFA trapNFA();
+
 void print_allocs();
 
-int main()
+int scan(int argc, char *argv[]);
+
+int main(int argc, char *argv[])
 {
+    if (argc > 1 && string(argv[1]) == "scan")
+    {
+        return scan(argc, argv);
+    }
+
+
     testDFA();
     print_allocs();
 
+    testCompiledDFA();
+    print_allocs();
+
+    testToCpp();
+    print_allocs();
+
+    testStaticDFA();
+    print_allocs();
+
+    testByteClasses();
+    print_allocs();
+
+    testMoves();
+    print_allocs();
+
     testNFA();
     print_allocs();
 
+    testBitsetNFA();
+    print_allocs();
+
+    testBitParallelNFA();
+    print_allocs();
+
+    testLazyDFA();
+    print_allocs();
+
     testENFA();
     print_allocs();
 
+    testCSRAutomaton();
+    print_allocs();
+
+    testLiveFA();
+    print_allocs();
+
+    testMatcher();
+    print_allocs();
+
+    testFileScanner();
+    print_allocs();
+
+    testSearcher();
+    print_allocs();
+
+    testPrefilter();
+    print_allocs();
+
     testProduct();
     print_allocs();
 
@@ -66,6 +161,86 @@ int main()
     return 0;
 }
 
+// usage: Automata scan <automaton.json> <file> [--offsets | --bitmap]
+// prints how many lines of the file the automaton accepts
+int scan(int argc, char *argv[])
+{
+    if (argc < 4 || argc > 5)
+    {
+        cerr << "usage: " << argv[0] << " scan <automaton.json> <file> [--offsets | --bitmap]" << endl;
+        return 1;
+    }
+    FileScanner::Report report = FileScanner::Report::COUNT;
+    if (argc == 5)
+    {
+        if (string(argv[4]) == "--offsets")
+        {
+            report = FileScanner::Report::OFFSETS;
+        }
+        else if (string(argv[4]) == "--bitmap")
+        {
+            report = FileScanner::Report::BITMAP;
+        }
+        else
+        {
+            cerr << "unknown option: " << argv[4] << endl;
+            return 1;
+        }
+    }
+
+    try
+    {
+        ifstream input_file(argv[2]);
+        if (input_file.fail())
+        {
+            throw runtime_error("file could not be found: " + string(argv[2]));
+        }
+        json j;
+        input_file >> j;
+
+        std::unique_ptr<FA> fa;
+        if (j["type"] == "DFA")
+        {
+            fa = std::make_unique<DFA>(std::set<Symbol>{});
+        }
+        else if (j["type"] == "NFA")
+        {
+            fa = std::make_unique<NFA>();
+        }
+        else if (j["type"] == "ENFA")
+        {
+            fa = std::make_unique<ENFA>();
+        }
+        else
+        {
+            throw runtime_error("Unknown automata type");
+        }
+        fa->fromJSON(j);
+
+        const FileScanner::Result result = FileScanner(*fa).scan(argv[3], report);
+        cout << "lines=" << result.lines << endl;
+        cout << "accepted=" << result.accepted << endl;
+        for (const size_t offset: result.offsets)
+        {
+            cout << offset << endl;
+        }
+        if (report == FileScanner::Report::BITMAP)
+        {
+            for (size_t line = 0; line < result.lines; line++)
+            {
+                cout << ((result.bitmap[line / 64] >> (line % 64)) & 1);
+            }
+            cout << endl;
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
+
 ////
 ///
 // TESTS
@@ -104,6 +279,376 @@ void testDFA()
     }
 }
 
+void testCompiledDFA()
+{
+    DFA dfa("jsons/DFA.json");
+    std::shared_ptr<const CompiledDFA> compiled = dfa.compile();
+    if (compiled->size() != dfa.getStates().size() + 1)
+    {
+        throw runtime_error("Failed test 0: compiled table has the wrong number of rows");
+    }
+    for (const string input: {"", "0", "1", "0001", "0010110100", "1111", "2", "01a"})
+    {
+        bool expected = true;
+        std::shared_ptr<State> state = dfa.getStartingState();
+        for (const char c: input)
+        {
+            state = dfa.getNextState(state, c);
+            if (state == nullptr)
+            {
+                expected = false;
+                break;
+            }
+        }
+        expected = expected && state->accepting;
+        if (compiled->accepts(input) != expected || dfa.accepts(input) != expected)
+        {
+            throw runtime_error("Failed test 1: compiled DFA disagrees on " + input);
+        }
+    }
+
+    std::vector<string> keys;
+    for (size_t i = 0; i < 150; i++)
+    {
+        keys.push_back(string(i % 13, '0') + (i % 3 == 0 ? "1" : "") + string(i % 5, '1'));
+    }
+    const std::vector<std::string_view> views(keys.begin(), keys.end());
+    const std::vector<uint64_t> accepted = dfa.acceptsMany(views);
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        if (((accepted[i / 64] >> (i % 64)) & 1) != dfa.accepts(keys[i]))
+        {
+            throw runtime_error("Failed test 2: acceptsMany disagrees on " + keys[i]);
+        }
+    }
+    if (compiled->acceptsMany(views.data(), views.size(), CompiledDFA::Kernel::SCALAR)
+        != compiled->acceptsMany(views.data(), views.size(), CompiledDFA::Kernel::AVX2))
+    {
+        throw runtime_error("Failed test 3: the acceptsMany kernels disagree");
+    }
+
+    string log;
+    for (size_t i = 0; i < (1 << 20); i++)
+    {
+        log += (i * 7919) % 11 < 5 ? '0' : '1';
+    }
+    for (const string suffix: {"", "1", "11", "2"})
+    {
+        const string input = log + suffix;
+        if (dfa.acceptsParallel(input, 4) != dfa.accepts(input) || dfa.acceptsParallel(input, 3) != dfa.accepts(input))
+        {
+            throw runtime_error("Failed test 4: acceptsParallel disagrees with accepts");
+        }
+    }
+
+    // every string that starts with an a, over all bytes
+    std::set<Symbol> bytes;
+    for (int byte = 0; byte < 256; byte++)
+    {
+        bytes.insert(static_cast<Symbol>(byte));
+    }
+    DFA prefix(bytes);
+    std::shared_ptr<State> start = prefix.newState("start", true, false);
+    std::shared_ptr<State> rest = prefix.newState("rest", false, true);
+    prefix.addState(start);
+    prefix.addState(rest);
+    prefix.addTransition(prefix.newTransition(start, rest, 'a'));
+    for (const Symbol byte: bytes)
+    {
+        prefix.addTransition(prefix.newTransition(rest, rest, byte));
+    }
+    std::shared_ptr<const CompiledDFA> sinks = prefix.compile();
+    if (sinks->getAcceptSink() == -1 || !sinks->isDecided(sinks->getNextState(sinks->getStartingState(), 'a'))
+        || sinks->getNextState(sinks->getStartingState(), 'b') != sinks->getDeadState())
+    {
+        throw runtime_error("Failed test 5: dead and accept sink states were not found");
+    }
+    if (!prefix.accepts("a" + log) || prefix.accepts("b" + log) || !prefix.accepts("abc") || prefix.accepts(""))
+    {
+        throw runtime_error("Failed test 6: early exit changed the answer");
+    }
+
+    dfa.clear();
+    dfa.fromPath("jsons/input-product-and1.json");
+    if (dfa.compile() == compiled)
+    {
+        throw runtime_error("Failed test 7: compiled table was not invalidated");
+    }
+
+    DFA flags("jsons/DFA.json");
+    const bool accepted_empty = flags.accepts("");
+    flags.setAccepting(flags.getStartingState(), !accepted_empty);
+    if (flags.accepts("") == accepted_empty)
+    {
+        throw runtime_error("Failed test 8: changing a flag did not invalidate the compiled table");
+    }
+
+    // several readers compile a shared const DFA at the same time
+    const DFA shared("jsons/DFA.json");
+    vector<thread> readers;
+    vector<int> results(4, -1);
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        readers.emplace_back([&shared, &results, i]() { results[i] = shared.accepts("0001"); });
+    }
+    for (thread &reader: readers)
+    {
+        reader.join();
+    }
+    if (results != vector<int>(4, 1))
+    {
+        throw runtime_error("Failed test 9: concurrent accepts disagree");
+    }
+
+    // counting modulo 100 permutes the states, no two runs ever merge
+    DFA counter;
+    counter.clear();
+    counter.setAlphabet({'0', '1'});
+    vector<shared_ptr<State>> counts;
+    for (size_t i = 0; i < 100; i++)
+    {
+        counts.push_back(counter.newState("c" + to_string(i), i == 0, i == 0));
+        counter.addState(counts.back());
+    }
+    for (size_t i = 0; i < counts.size(); i++)
+    {
+        counter.addTransition(counter.newTransition(counts[i], counts[(i + 1) % counts.size()], '0'));
+        counter.addTransition(counter.newTransition(counts[i], counts[i], '1'));
+    }
+    const string zeros(1 << 20, '0');
+    if (!counter.compile()->summarize(zeros.data(), zeros.size(), zeros.size()).empty()
+        || counter.acceptsParallel(zeros, 4) != counter.accepts(zeros)
+        || counter.acceptsParallel(zeros + "0", 4) != counter.accepts(zeros + "0")
+        || dfa.compile()->summarize(log.data(), log.size(), log.size()).empty())
+    {
+        throw runtime_error("Failed test 10: acceptsParallel did not fall back on a permutation DFA");
+    }
+
+    // a copy shares its states, changing them through the copy invalidates the original's table too
+    DFA original("jsons/DFA.json");
+    const bool original_empty = original.accepts("");
+    DFA copy = original;
+    copy.setAccepting(copy.getStartingState(), !original_empty);
+    if (original.accepts("") == original_empty || copy.accepts("") == original_empty)
+    {
+        throw runtime_error("Failed test 11: a copy left the compiled table of the original stale");
+    }
+}
+
+void testToCpp()
+{
+    // the generated headers are compiled into this test, they have to match what is generated now
+    const DFA dfa("jsons/DFA.json");
+    auto read = [](const string &path) {
+        ifstream file(path);
+        return string(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    };
+    if (dfa.to_cpp("dfa_table", DFA::CppStyle::TABLE) != read("cpp/DFA-table.h")
+        || dfa.to_cpp("dfa_switch", DFA::CppStyle::SWITCH) != read("cpp/DFA-switch.h"))
+    {
+        throw runtime_error("Failed test 1: cpp/ is out of date with to_cpp");
+    }
+
+    vector<string> inputs = {"", "0", "1", "2", "0001", "01x", "x01"};
+    for (size_t length = 1; length <= 8; length++)
+    {
+        for (size_t bits = 0; bits < (size_t(1) << length); bits++)
+        {
+            string input;
+            for (size_t i = 0; i < length; i++)
+            {
+                input.push_back((bits >> i) & 1 ? '1' : '0');
+            }
+            inputs.push_back(input);
+        }
+    }
+    for (const string &input: inputs)
+    {
+        const bool expected = dfa.accepts(input);
+        if (dfa_table(input.data(), input.size()) != expected || dfa_switch(input.data(), input.size()) != expected)
+        {
+            throw runtime_error("Failed test 2: generated code disagrees on '" + input + "'");
+        }
+    }
+}
+
+void testStaticDFA()
+{
+    static constexpr auto dfa = makeStaticDFA("(a+b)*abb", 'e');
+    static_assert(dfa.accepts("abb") && dfa.accepts("babaabb") && !dfa.accepts("ab") && !dfa.accepts("abbx"));
+    static_assert(makeStaticDFA("e", 'e').accepts("") && !makeStaticDFA("()", 'e').accepts(""));
+    // a star stars the whole concatenation before it, as in RE
+    static constexpr auto star = makeStaticDFA("ab*", 'e');
+    static_assert(star.accepts("") && star.accepts("ab") && star.accepts("abab") && !star.accepts("a") &&
+                  !star.accepts("abb"));
+
+    // the same language as the runtime construction
+    const vector<pair<string, string>> regexes = {{"(a+b)*abb", "abx"}, {"ab(c+d)*+e", "abcdx"},
+                                                  {"(ab+ba)*a", "abx"}, {"a(b+e)(c)*", "abcx"},
+                                                  {"a(b+e)c*", "abcx"}, {"ab*", "abx"}};
+    static constexpr auto first = makeStaticDFA("(a+b)*abb", 'e');
+    static constexpr auto second = makeStaticDFA("ab(c+d)*+e", 'e');
+    static constexpr auto third = makeStaticDFA("(ab+ba)*a", 'e');
+    static constexpr auto fourth = makeStaticDFA("a(b+e)(c)*", 'e');
+    static constexpr auto fifth = makeStaticDFA("a(b+e)c*", 'e');
+    for (size_t r = 0; r < regexes.size(); r++)
+    {
+        const ENFA enfa = RE(regexes[r].first, 'e').toENFA();
+        const string &symbols = regexes[r].second;
+        vector<string> inputs = {""};
+        for (size_t i = 0; i < inputs.size() && inputs[i].size() < 6; i++)
+        {
+            for (const char symbol: symbols)
+            {
+                inputs.push_back(inputs[i] + symbol);
+            }
+        }
+        for (const string &input: inputs)
+        {
+            const bool accepted = r == 0 ? first.accepts(input)
+                                         : r == 1 ? second.accepts(input)
+                                                  : r == 2 ? third.accepts(input)
+                                                           : r == 3 ? fourth.accepts(input)
+                                                                    : r == 4 ? fifth.accepts(input)
+                                                                             : star.accepts(input);
+            if (accepted != enfa.accepts(input))
+            {
+                throw runtime_error("Failed test 1: " + regexes[r].first + " disagrees with RE on '" + input + "'");
+            }
+        }
+    }
+}
+
+void testByteClasses()
+{
+    // (a(b+c))*
+    DFA dfa;
+    dfa.clear();
+    dfa.setAlphabet({'a', 'b', 'c'});
+    std::shared_ptr<State> q0 = dfa.newState("q0", true, true);
+    std::shared_ptr<State> q1 = dfa.newState("q1", false, false);
+    dfa.addState(q0);
+    dfa.addState(q1);
+    dfa.addTransition(dfa.newTransition(q0, q1, 'a'));
+    dfa.addTransition(dfa.newTransition(q1, q0, 'b'));
+    dfa.addTransition(dfa.newTransition(q1, q0, 'c'));
+
+    ByteClasses classes(dfa);
+    // a, b and c together, every other byte
+    if (classes.size() != 3)
+    {
+        throw runtime_error("Failed test 0: expected 3 byte classes, got " + to_string(classes.size()));
+    }
+    if (classes.get('b') != classes.get('c') || classes.get('a') == classes.get('b'))
+    {
+        throw runtime_error("Failed test 1: b and c should share a class apart from a");
+    }
+    if (classes.partition(dfa.getAlphabet()).size() != 2)
+    {
+        throw runtime_error("Failed test 2: alphabet should be split in 2 groups");
+    }
+    if (dfa.compile()->getStride() != classes.size())
+    {
+        throw runtime_error("Failed test 3: compiled table is not class indexed");
+    }
+    if (!dfa.accepts("abacab") || dfa.accepts("abca") || dfa.accepts("ad"))
+    {
+        throw runtime_error("Failed test 4: class indexed table gives wrong results");
+    }
+}
+
+void testMoves()
+{
+    static_assert(std::is_nothrow_move_constructible_v<DFA>);
+    static_assert(std::is_nothrow_move_assignable_v<ENFA>);
+
+    DFA empty(std::set<Symbol>{'a', 'b'});
+    if (!empty.getStates().empty() || empty.getStartingState() != nullptr || empty.getAlphabet().size() != 2)
+    {
+        throw runtime_error("Failed test 1: DFA(alphabet) is not empty");
+    }
+
+    DFA dfa("jsons/DFA.json");
+    const std::shared_ptr<State> start = dfa.getStartingState();
+    const size_t transitions = dfa.getTransitions().size();
+    DFA moved(std::move(dfa));
+    if (moved.getStartingState() != start || moved.getTransitions().size() != transitions)
+    {
+        throw runtime_error("Failed test 2: moving a DFA copied its states");
+    }
+    if (!moved.accepts("0001") || moved.accepts("0010110100"))
+    {
+        throw runtime_error("Failed test 3: moved DFA does not accept the same language");
+    }
+
+    RE re("(a+b)*c", 'e');
+    ENFA enfa = re.toENFA();
+    DFA dfa2 = enfa.toDFA();
+    if (!dfa2.accepts("abbac") || dfa2.accepts("abba"))
+    {
+        throw runtime_error("Failed test 4: RE -> ENFA -> DFA pipeline is broken");
+    }
+    DFA min = dfa2.minimize();
+    if (min.getStates().size() != 3)
+    {
+        throw runtime_error("Failed test 5: minimized DFA does not have 3 states");
+    }
+
+    // the memory of released states is reused, a state that outlives its automaton stays valid
+    DFA reused(std::set<Symbol>{'a'});
+    size_t allocated = 0;
+    for (size_t round = 0; round < 3; round++)
+    {
+        reused.clear();
+        for (size_t i = 0; i < 1000; i++)
+        {
+            reused.addState(reused.newState("q" + to_string(i), i == 0, false));
+        }
+        allocated = round == 0 ? reused.getArena()->bytesAllocated() : allocated;
+    }
+    shared_ptr<State> kept;
+    {
+        DFA owner("jsons/DFA.json");
+        kept = owner.getStartingState();
+    }
+    if (reused.getArena()->bytesAllocated() != allocated || kept->getName() != "Q0")
+    {
+        throw runtime_error("Failed test 6: the arena does not reuse or keep its states");
+    }
+
+    // states that outlive their automaton are released on several threads, the last one frees the arena
+    vector<vector<shared_ptr<State>>> held(4);
+    {
+        DFA owner(std::set<Symbol>{'a'});
+        owner.clear();
+        for (size_t i = 0; i < 4000; i++)
+        {
+            held[i % held.size()].push_back(owner.newState("q" + to_string(i), i == 0, false));
+            owner.addState(held[i % held.size()].back());
+            owner.addTransition(owner.newTransition(owner.getStartingState(), held[i % held.size()].back(), 'a'));
+        }
+    }
+    vector<char> valid(held.size());
+    vector<thread> releasers;
+    for (size_t part = 0; part < held.size(); part++)
+    {
+        releasers.emplace_back([&held, &valid, part]() {
+            valid[part] = std::all_of(held[part].begin(), held[part].end(), [](const shared_ptr<State> &state) {
+                return state->getName()[0] == 'q';
+            });
+            held[part].clear();
+        });
+    }
+    for (thread &releaser: releasers)
+    {
+        releaser.join();
+    }
+    if (std::count(valid.begin(), valid.end(), true) != 4)
+    {
+        throw runtime_error("Failed test 7: states released on several threads are not valid");
+    }
+}
+
 void testNFA()
 {
     NFA nfa("jsons/input-ssc1.json");
@@ -118,6 +663,308 @@ void testNFA()
     {
         throw runtime_error("Failed test 1: SSC2 is incorrect");
     }
+
+    // the subset construction runs once, until the automaton changes
+    const bool accepted = nfa.accepts("c");
+    const shared_ptr<const DFA> determinized = nfa.determinize();
+    if (nfa.accepts("c") != accepted || nfa.determinize() != determinized)
+    {
+        throw runtime_error("Failed test 2: accepts determinized again");
+    }
+    nfa.setAlphabet({'c', 'd'});
+    const shared_ptr<State> extra = nfa.newState("extra", false, true);
+    nfa.addState(extra);
+    nfa.addTransition(nfa.newTransition(nfa.getStartingState(), extra, 'd'));
+    if (nfa.determinize() == determinized || !nfa.accepts("d") || nfa.accepts("c") != accepted)
+    {
+        throw runtime_error("Failed test 3: a mutation did not invalidate the determinized DFA");
+    }
+
+    // every subset of the last 9 positions is reached once, the starting subset is reached on its own
+    string regex = "(a+b)*a";
+    for (size_t i = 0; i < 8; i++)
+    {
+        regex += "(a+b)";
+    }
+    const DFA exploded = RE(regex, 'e').toENFA().toDFA();
+    if (exploded.getStates().size() != 513 || !exploded.accepts("abbbbbbbb") || exploded.accepts("abbbbbbb"))
+    {
+        throw runtime_error("Failed test 4: the subset construction found the wrong subsets");
+    }
+
+    // the subsets only name the states of the NFA by id, the NFA and its arena can go first
+    DFA subsets;
+    weak_ptr<Arena> source_arena;
+    {
+        const NFA source("jsons/input-ssc1.json");
+        source_arena = source.getArena();
+        subsets = source.toDFA();
+    }
+    if (!source_arena.expired() || !compareSrcJSON("jsons/expected_output-ssc1.json", subsets.to_json()))
+    {
+        throw runtime_error("Failed test 5: the subset construction keeps the NFA alive");
+    }
+
+    // the names are built once however many threads ask for them
+    const DFA unnamed = NFA("jsons/input-ssc2.json").toDFA();
+    vector<vector<string>> names(4);
+    vector<thread> readers;
+    for (vector<string> &read: names)
+    {
+        readers.emplace_back([&unnamed, &read]() {
+            for (const shared_ptr<State> &state: unnamed.getStates())
+            {
+                read.push_back(state->getName());
+            }
+        });
+    }
+    for (thread &reader: readers)
+    {
+        reader.join();
+    }
+    if (names[0] != names[1] || names[0] != names[2] || names[0] != names[3]
+        || !compareSrcJSON("jsons/expected_output-ssc2.json", unnamed.to_json()))
+    {
+        throw runtime_error("Failed test 6: concurrent naming disagrees");
+    }
+
+    // readers that find no determinized dfa yet may build it at the same time
+    const NFA shared("jsons/input-ssc2.json");
+    const bool expected = NFA("jsons/input-ssc2.json").accepts("0110");
+    vector<char> answers(8);
+    readers.clear();
+    for (char &answer: answers)
+    {
+        readers.emplace_back([&shared, &answer]() {
+            answer = shared.accepts("0110");
+        });
+    }
+    for (thread &reader: readers)
+    {
+        reader.join();
+    }
+    if (std::count(answers.begin(), answers.end(), expected) != 8)
+    {
+        throw runtime_error("Failed test 7: concurrent determinizing disagrees");
+    }
+
+    // the first lookups by name index the derived states, whichever reader comes first
+    const DFA lookup = NFA("jsons/input-ssc2.json").toDFA();
+    vector<char> found(8);
+    readers.clear();
+    for (char &all: found)
+    {
+        readers.emplace_back([&lookup, &names, &all]() {
+            all = std::all_of(names[0].begin(), names[0].end(), [&lookup](const string &name) {
+                const shared_ptr<State> state = lookup.getState(name);
+                return state != nullptr && state->getName() == name;
+            });
+        });
+    }
+    for (thread &reader: readers)
+    {
+        reader.join();
+    }
+    if (std::count(found.begin(), found.end(), true) != 8)
+    {
+        throw runtime_error("Failed test 8: concurrent lookups by name disagree");
+    }
+}
+
+void testBitsetNFA()
+{
+    // (a+b)*a(a+b)^n has 2^(n+1) subsets, the simulation only needs its own states
+    string regex = "(a+b)*a";
+    for (size_t i = 0; i < 12; i++)
+    {
+        regex += "(a+b)";
+    }
+    const ENFA enfa = RE(regex, 'e').toENFA();
+    const BitsetNFA simulation(enfa);
+    if (simulation.size() != enfa.getStates().size() || !simulation.accepts("abbbbbbbbbbbb")
+        || simulation.accepts("baaaaaaaaaaaa") || simulation.accepts("abbbbbbbbbbb"))
+    {
+        throw runtime_error("Failed test 1: wrong result for (a+b)*a(a+b)^12");
+    }
+
+    // the same as the subset construction on every short input
+    const ENFA small = RE("(ab+a)*(b+e)", 'e').toENFA();
+    vector<string> inputs = {""};
+    for (size_t i = 0; i < inputs.size() && inputs[i].size() < 7; i++)
+    {
+        inputs.push_back(inputs[i] + 'a');
+        inputs.push_back(inputs[i] + 'b');
+    }
+    inputs.emplace_back("e");
+    inputs.emplace_back("aeb");
+    for (const string &input: inputs)
+    {
+        if (small.simulate(input) != small.accepts(input))
+        {
+            throw runtime_error("Failed test 2: simulate disagrees with accepts on '" + input + "'");
+        }
+    }
+
+    NFA nfa("jsons/input-ssc2.json");
+    for (const string &input: inputs)
+    {
+        if (nfa.simulate(input) != nfa.accepts(input))
+        {
+            throw runtime_error("Failed test 3: simulate disagrees with accepts on '" + input + "'");
+        }
+    }
+
+    const NFA trap = trapNFA();
+    const BitsetNFA trapped(trap);
+    for (const string input: {"", "a", "b", "ab", "bb", "bbbb"})
+    {
+        if (trapped.accepts(input) != trap.accepts(input))
+        {
+            throw runtime_error("Failed test 4: simulate disagrees with accepts on '" + input + "'");
+        }
+    }
+
+    // readers that find no simulation yet may build it at the same time
+    const NFA shared("jsons/input-ssc2.json");
+    vector<char> answers(8);
+    vector<thread> readers;
+    for (char &answer: answers)
+    {
+        readers.emplace_back([&shared, &answer]() {
+            answer = shared.simulate("0110");
+        });
+    }
+    for (thread &reader: readers)
+    {
+        reader.join();
+    }
+    if (std::count(answers.begin(), answers.end(), nfa.accepts("0110")) != 8)
+    {
+        throw runtime_error("Failed test 5: concurrent simulating disagrees");
+    }
+}
+
+void testBitParallelNFA()
+{
+    vector<string> inputs = {""};
+    for (size_t i = 0; i < inputs.size() && inputs[i].size() < 7; i++)
+    {
+        inputs.push_back(inputs[i] + 'a');
+        inputs.push_back(inputs[i] + 'b');
+        inputs.push_back(inputs[i] + 'c');
+    }
+
+    // the star after a symbol binds like in RE
+    for (const string regex: {"(a+b)*abb", "ab*c+e", "(ab+a)*(b+e)", "a(b+c)(a)*", "()", "e"})
+    {
+        const BitParallelNFA bits{RE(regex, 'e')};
+        const ENFA enfa = RE(regex, 'e').toENFA();
+        for (const string &input: inputs)
+        {
+            if (bits.accepts(input) != enfa.accepts(input))
+            {
+                throw runtime_error("Failed test 1: " + regex + " disagrees with RE on '" + input + "'");
+            }
+        }
+    }
+
+    NFA nfa("jsons/input-ssc1.json");
+    const BitParallelNFA split(nfa);
+    for (const string input: {"", "c", "cc", "ccc", "cccc", "ccccc", "cd"})
+    {
+        if (split.accepts(input) != nfa.accepts(input))
+        {
+            throw runtime_error("Failed test 2: the NFA disagrees on '" + input + "'");
+        }
+    }
+
+    // more than 64 and more than 128 positions
+    string wide;
+    for (size_t i = 0; i < 100; i++)
+    {
+        wide += "(a+b)";
+    }
+    const BitParallelNFA large{RE(wide, 'e')};
+    if (large.getWords() != 4 || !large.accepts(string(100, 'b')) || large.accepts(string(99, 'a'))
+        || BitParallelNFA(RE(wide.substr(0, 5 * 40), 'e')).getWords() != 2)
+    {
+        throw runtime_error("Failed test 3: wrong result with several words");
+    }
+    try
+    {
+        (void) BitParallelNFA(RE(wide + wide, 'e'));
+        throw runtime_error("Failed test 4: an automaton with too many states was accepted");
+    }
+    catch (const runtime_error &error)
+    {
+        if (string(error.what()).find("Failed") == 0)
+        {
+            throw;
+        }
+    }
+}
+
+void testLazyDFA()
+{
+    // (a+b)*a(a+b)^10 determinizes to 2^11 states
+    string regex = "(a+b)*a";
+    for (size_t i = 0; i < 10; i++)
+    {
+        regex += "(a+b)";
+    }
+    const ENFA enfa = RE(regex, 'e').toENFA();
+    const BitsetNFA reference(enfa);
+
+    string text;
+    for (size_t i = 0; i < 2000; i++)
+    {
+        text.push_back((i * 7 + i / 3) % 5 < 2 ? 'a' : 'b');
+    }
+    vector<string> inputs;
+    for (size_t length = 0; length < 40; length++)
+    {
+        inputs.push_back(text.substr(length * 37, length + 11));
+    }
+    inputs.push_back(text);
+    inputs.emplace_back("abbbbbbbbbbe");
+
+    const LazyDFA unbounded(enfa);
+    const LazyDFA bounded(enfa, 4096);
+    for (const string &input: inputs)
+    {
+        if (unbounded.accepts(input) != reference.accepts(input) || bounded.accepts(input) != reference.accepts(input))
+        {
+            throw runtime_error("Failed test 1: the lazy DFA disagrees on '" + input + "'");
+        }
+    }
+    if (unbounded.getCacheClears() != 0 || bounded.getCacheClears() == 0 || bounded.memoryUsage() > 4096)
+    {
+        throw runtime_error("Failed test 2: the cache did not respect its budget");
+    }
+
+    // the second run over the same input only reads the cache
+    const size_t cached = unbounded.getCachedStates();
+    if (unbounded.accepts(text) != reference.accepts(text) || unbounded.getCachedStates() != cached)
+    {
+        throw runtime_error("Failed test 3: the cache was not reused");
+    }
+
+    NFA nfa("jsons/input-ssc2.json");
+    const LazyDFA lazy(nfa);
+    for (const string input: {"", "0", "1", "01", "10", "0110", "111", "p"})
+    {
+        if (lazy.accepts(input) != nfa.accepts(input))
+        {
+            throw runtime_error("Failed test 4: the lazy DFA disagrees with accepts on '" + input + "'");
+        }
+    }
+
+    // the subset of the trap state can not accept, it is the dead state and is never cached
+    const LazyDFA trapped(trapNFA());
+    if (trapped.accepts("bbbb") || !trapped.accepts("a") || trapped.getCachedStates() != 2)
+    {
+        throw runtime_error("Failed test 5: a subset that can not accept is not dead");
+    }
 }
 
 void testENFA()
@@ -127,6 +974,386 @@ void testENFA()
     {
         throw runtime_error("Failed test 0: ENFA is incorrect");
     }
+
+    ENFA regex = RE("(ab)*(c+d)", 'e').toENFA();
+    const shared_ptr<const DFA> determinized = regex.determinize();
+    if (!regex.accepts("ababc") || regex.accepts("aba") || regex.determinize() != determinized)
+    {
+        throw runtime_error("Failed test 1: accepts determinized again");
+    }
+    const size_t revision = regex.getRevision();
+    regex.optimizeStart();
+    regex.optimizeAccept();
+    if ((regex.getRevision() != revision && regex.determinize() == determinized) || !regex.accepts("ababc"))
+    {
+        throw runtime_error("Failed test 2: an optimization did not invalidate the determinized DFA");
+    }
+
+    // a single state without transitions still has a starting subset
+    const ENFA empty = RE("e", 'e').toENFA();
+    if (!empty.accepts("") || !empty.simulate("") || empty.toDFA().getStates().size() != 1)
+    {
+        throw runtime_error("Failed test 3: the empty word is not accepted without transitions");
+    }
+
+    // removing states moves others, lookups by name still find them
+    ENFA optimized;
+    optimized.setAlphabet({'a'});
+    optimized.setEpsilon('e');
+    const shared_ptr<State> q0 = optimized.newState("q0", true, false);
+    const shared_ptr<State> q3 = optimized.newState("q3", false, true);
+    const shared_ptr<State> q1 = optimized.newState("q1", false, false);
+    const shared_ptr<State> q2 = optimized.newState("q2", false, false);
+    for (const shared_ptr<State> &state: {q0, q3, q1, q2})
+    {
+        optimized.addState(state);
+    }
+    optimized.addTransition(optimized.newTransition(q0, q1, 'e'));
+    optimized.addTransition(optimized.newTransition(q1, q2, 'a'));
+    optimized.addTransition(optimized.newTransition(q2, q3, 'e'));
+    optimized.optimizeStart();
+    optimized.optimizeAccept();
+    if (optimized.getStates().size() != 2 || !optimized.accepts("a") || optimized.accepts("")
+        || optimized.getState("q1") != q1 || optimized.getState("q2") != q2 || optimized.getState("q0") != nullptr)
+    {
+        throw runtime_error("Failed test 4: removing states broke the index by name");
+    }
+}
+
+void testCSRAutomaton()
+{
+    ENFA enfa("jsons/input-mssc1.json");
+    CSRAutomaton csr;
+    csr.fromPath("jsons/input-mssc1.json");
+    if (csr.size() != enfa.getStates().size() || csr.transitionCount() != enfa.getTransitions().size())
+    {
+        throw runtime_error("Failed test 0: CSR automaton has the wrong size");
+    }
+    for (const string input: {"", "k", "j", "kj", "jk", "kkjj", "jjjk", "kjkjkj", "x"})
+    {
+        if (csr.accepts(input) != enfa.accepts(input))
+        {
+            throw runtime_error("Failed test 1: CSR automaton disagrees on " + input);
+        }
+    }
+    if (csr.getState(enfa.getStartingState()->getName()) != csr.getStartingState())
+    {
+        throw runtime_error("Failed test 2: state lookup by name is wrong");
+    }
+
+    ENFA rebuilt;
+    CSRAutomaton(enfa).toFA(rebuilt);
+    if (rebuilt.to_stats() != enfa.to_stats() || !compareSrcJSON("jsons/expected_output-mssc1.json",
+                                                                  rebuilt.toDFA().to_json()))
+    {
+        throw runtime_error("Failed test 3: CSR round trip is not equal to the original automaton");
+    }
+
+    // lookups by name keep working in copies and after a move
+    CSRAutomaton copy = csr;
+    const CSRAutomaton::StateId start = copy.getState(copy.getName(copy.getStartingState()));
+    CSRAutomaton moved = std::move(csr);
+    if (start != copy.getStartingState() || moved.getState(moved.getName(start)) != start
+        || moved.getState("no such state") != CSRAutomaton::NO_STATE)
+    {
+        throw runtime_error("Failed test 4: state lookup by name is wrong after a copy or move");
+    }
+
+    json two_symbols = {{"type", "DFA"}, {"alphabet", {"a"}},
+                        {"states", {{{"name", "q"}, {"starting", true}, {"accepting", true}}}},
+                        {"transitions", {{{"from", "q"}, {"to", "q"}, {"input", "ab"}}}}};
+    bool thrown = false;
+    try
+    {
+        CSRAutomaton().fromJSON(two_symbols);
+    }
+    catch (const runtime_error &)
+    {
+        thrown = true;
+    }
+    if (!thrown)
+    {
+        throw runtime_error("Failed test 5: an input of more than one symbol is accepted");
+    }
+
+    // the subsets of a determinized automaton are only named when the CSR is asked for a name,
+    // and their table outlives the automaton
+    CSRAutomaton derived;
+    bool named = true;
+    string last_name;
+    {
+        const DFA subsets = NFA("jsons/input-ssc2.json").toDFA();
+        derived = CSRAutomaton(subsets);
+        named = std::any_of(subsets.getStates().begin(), subsets.getStates().end(),
+                            [](const shared_ptr<State> &state) { return state->isNamed(); });
+        last_name = subsets.getStates().back()->getName();
+    }
+    if (named || derived.getName(derived.size() - 1) != last_name
+        || derived.getState(last_name) != derived.size() - 1)
+    {
+        throw runtime_error("Failed test 6: the CSR names the states of the automaton it is built from");
+    }
+}
+
+void testLiveFA()
+{
+    RE re("(m+y)*+(e+y+m+i)s", 'e');
+    FrozenFA frozen(re.toENFA());
+    if (!frozen.accepts("mymy") || !frozen.accepts("is") || frozen.accepts("mys") || frozen.getType() != "ENFA")
+    {
+        throw runtime_error("Failed test 1: frozen ENFA does not accept the same language");
+    }
+
+    // the two versions accept exactly one of "0001" and "0010110100"
+    DFA sample;
+    DFA file("jsons/DFA.json");
+    LiveFA live(file);
+
+    std::atomic<bool> done{false};
+    std::atomic<bool> torn{false};
+    std::vector<std::thread> workers;
+    for (int i = 0; i < 4; i++)
+    {
+        workers.emplace_back([&live, &done, &torn]() {
+            LiveFA::Reader reader(live);
+            while (!done.load())
+            {
+                const bool consistent = reader.read([](const FrozenFA *snapshot) {
+                    return snapshot->accepts("0001") != snapshot->accepts("0010110100");
+                });
+                if (!consistent)
+                {
+                    torn.store(true);
+                }
+            }
+        });
+    }
+    for (int i = 0; i < 200; i++)
+    {
+        live.publish(i % 2 == 0 ? static_cast<const FA &>(sample) : file);
+    }
+    done.store(true);
+    for (std::thread &worker: workers)
+    {
+        worker.join();
+    }
+    if (torn.load())
+    {
+        throw runtime_error("Failed test 2: a reader saw two versions in one read");
+    }
+
+    live.synchronize();
+    if (live.getRetiredCount() != 0)
+    {
+        throw runtime_error("Failed test 3: replaced snapshots were not freed");
+    }
+    LiveFA::Reader reader(live);
+    if (!reader.accepts("0001") || reader.accepts("0010110100"))
+    {
+        throw runtime_error("Failed test 4: the last published version is not current");
+    }
+}
+
+void testMatcher()
+{
+    // every string up to length 4, fed in chunks of 1, 2 and 3 bytes
+    auto check = [](const FA &fa, const string &test) {
+        Matcher matcher(fa);
+        vector<string> strings = {""};
+        for (size_t i = 0; i < strings.size(); i++)
+        {
+            if (strings[i].size() < 4)
+            {
+                for (const Symbol symbol: fa.getAlphabet())
+                {
+                    strings.push_back(strings[i] + symbol);
+                }
+            }
+        }
+        for (const string &input: strings)
+        {
+            for (size_t chunk = 1; chunk <= 3; chunk++)
+            {
+                matcher.reset();
+                for (size_t begin = 0; begin < input.size(); begin += chunk)
+                {
+                    matcher.feed(string_view(input).substr(begin, chunk));
+                }
+                if (matcher.isAccepting() != fa.accepts(input))
+                {
+                    throw runtime_error("Failed test " + test + ": matcher disagrees on " + input);
+                }
+            }
+        }
+    };
+
+    check(DFA("jsons/DFA.json"), "1");
+    check(NFA("jsons/input-ssc1.json"), "2");
+    check(ENFA("jsons/input-mssc1.json"), "3");
+
+    RE re("(m+y)*+(e+y+m+i)s", 'e');
+    Matcher matcher(re.toENFA());
+    matcher.feed("mym");
+    matcher.feed("ymy");
+    if (!matcher.isAccepting() || matcher.isDead())
+    {
+        throw runtime_error("Failed test 4: matcher did not accept mymymy");
+    }
+    matcher.feed("s");
+    if (matcher.isAccepting() || !matcher.isDead())
+    {
+        throw runtime_error("Failed test 5: matcher did not reject mymymys");
+    }
+    matcher.reset();
+    matcher.feed("i");
+    matcher.feed("s");
+    if (!matcher.isAccepting())
+    {
+        throw runtime_error("Failed test 6: matcher did not accept is after a reset");
+    }
+
+    const NFA trap = trapNFA();
+    Matcher trapped(trap);
+    trapped.feed("b");
+    if (!trapped.isDead() || trapped.isAccepting())
+    {
+        throw runtime_error("Failed test 7: matcher is not dead in a state that can not accept");
+    }
+    check(trap, "8");
+}
+
+void testFileScanner()
+{
+    const string path = (filesystem::temp_directory_path() / "automata-scan-test.txt").string();
+    {
+        ofstream file(path);
+        file << "0001\n0010110100\n\n1\n01\n0110";
+    }
+
+    FileScanner scanner(DFA("jsons/DFA.json"));
+    const FileScanner::Result counted = scanner.scan(path);
+    const FileScanner::Result offsets = scanner.scan(path, FileScanner::Report::OFFSETS);
+    const FileScanner::Result bitmap = scanner.scan(path, FileScanner::Report::BITMAP);
+    filesystem::remove(path);
+
+    if (counted.lines != 6 || counted.accepted != 3 || !counted.offsets.empty() || !counted.bitmap.empty())
+    {
+        throw runtime_error("Failed test 1: scan counted the wrong lines");
+    }
+    if (offsets.offsets != vector<size_t>{0, 17, 19})
+    {
+        throw runtime_error("Failed test 2: scan reported the wrong offsets");
+    }
+    if (bitmap.bitmap != vector<uint64_t>{0b011001})
+    {
+        throw runtime_error("Failed test 3: scan reported the wrong bitmap");
+    }
+
+    const string records = "0001;1;;";
+    if (FileScanner(DFA("jsons/DFA.json"), ';').scan(records.data(), records.size()).lines != 3)
+    {
+        throw runtime_error("Failed test 4: scan did not split on the delimiter");
+    }
+}
+
+void testSearcher()
+{
+    using Match = Searcher::Match;
+
+    Searcher search(RE("ab(c+d)", 'e'));
+    if (!search.contains("xxabcyy") || search.contains("xxabyy"))
+    {
+        throw runtime_error("Failed test 1: contains is wrong");
+    }
+    if (search.findAll("xxabcyyabdzab") != vector<Match>{{2, 5}, {7, 10}})
+    {
+        throw runtime_error("Failed test 2: findAll is wrong");
+    }
+
+    // leftmost wins over earliest ending, longest wins over shortest
+    if (Searcher(RE("abcd+c", 'e')).find("abcd") != Match{0, 4})
+    {
+        throw runtime_error("Failed test 3: find is not leftmost");
+    }
+    if (Searcher(RE("a+aa", 'e')).findAll("aaa") != vector<Match>{{0, 2}, {2, 3}})
+    {
+        throw runtime_error("Failed test 4: findAll is not longest");
+    }
+    if (Searcher(RE("a+aa", 'e')).find("xyz").has_value())
+    {
+        throw runtime_error("Failed test 5: find matched nothing");
+    }
+
+    // against every substring
+    DFA dfa("jsons/DFA.json");
+    Searcher parity(dfa);
+    const string text = "1101201001110";
+    std::optional<Match> expected;
+    for (size_t begin = 0; begin <= text.size() && !expected; begin++)
+    {
+        for (size_t end = text.size() + 1; end-- > begin;)
+        {
+            if (dfa.accepts(text.substr(begin, end - begin)))
+            {
+                expected = Match{begin, end};
+                break;
+            }
+        }
+    }
+    if (parity.find(text) != expected)
+    {
+        throw runtime_error("Failed test 6: find disagrees with accepts on substrings");
+    }
+
+    // matches are not extended past the last match end
+    if (Searcher(RE("a+a*b", 'e')).findAll("aaacab") != vector<Match>{{0, 1}, {1, 2}, {2, 3}, {4, 6}}
+        || Searcher(RE("(a)*", 'e')).findAll("aaaa") != vector<Match>{{0, 4}, {4, 4}})
+    {
+        throw runtime_error("Failed test 7: findAll is wrong");
+    }
+}
+
+void testPrefilter()
+{
+    if (Prefilter(RE("(a+b)*xyz(c+d)", 'e')).getLiteral() != "xyz"
+        || Prefilter(RE("abcd+abcf", 'e')).getLiteral() != "abc"
+        || Prefilter(RE("ab(c+d)*yz+yzq", 'e')).getLiteral() != "yz"
+        || !Prefilter(RE("(ab)*", 'e')).getLiteral().empty())
+    {
+        throw runtime_error("Failed test 1: wrong literal from the syntax tree");
+    }
+
+    // every accepting path passes through x, y and z in a row
+    const CompiledDFA compiled(RE("(a+b)*xyz(c+d)*", 'e').toENFA().toDFA());
+    if (Prefilter(compiled).getLiteral() != "xyz")
+    {
+        throw runtime_error("Failed test 2: wrong literal from the dominators");
+    }
+    if (!Prefilter(CompiledDFA(DFA("jsons/DFA.json"))).getLiteral().empty())
+    {
+        throw runtime_error("Failed test 3: a literal that is not required");
+    }
+
+    const Prefilter prefilter("xyz");
+    const string text = "abxyxyzab";
+    if (!prefilter.mayMatch(text.data(), text.size()) || prefilter.find(text.data(), text.size()) != 4
+        || prefilter.mayMatch(text.data(), 6) || !Prefilter().mayMatch(text.data(), 0))
+    {
+        throw runtime_error("Failed test 4: mayMatch is wrong");
+    }
+
+    // the prefilter must not change the results
+    const string lines = "abxyzc\nxyz\nabxyc\naxyzdd\nxy\nz\n";
+    const FileScanner::Result scanned = FileScanner(RE("(a+b)*xyz(c+d)*", 'e').toENFA().toDFA())
+            .scan(lines.data(), lines.size(), FileScanner::Report::OFFSETS);
+    if (scanned.lines != 6 || scanned.offsets != vector<size_t>{0, 7, 17})
+    {
+        throw runtime_error("Failed test 5: the prefilter rejected an accepted line");
+    }
+    if (Searcher(RE("b*xyz", 'e')).findAll("xyxyzbbxyz") != vector<Searcher::Match>{{2, 5}, {5, 10}})
+    {
+        throw runtime_error("Failed test 6: the prefilter changed the matches");
+    }
 }
 
 void testProduct()
@@ -373,3 +1600,20 @@ bool compareSrcJSON(const string &src, json j2)
 
     return j1 == j2;
 }
+
+// accepts only a, b leads into a state that loops on b without ever accepting
+NFA trapNFA()
+{
+    NFA trap;
+    trap.setAlphabet({'a', 'b'});
+    const shared_ptr<State> q0 = trap.newState("q0", true, false);
+    const shared_ptr<State> q1 = trap.newState("q1", false, true);
+    const shared_ptr<State> q2 = trap.newState("q2", false, false);
+    trap.addState(q0);
+    trap.addState(q1);
+    trap.addState(q2);
+    trap.addTransition(trap.newTransition(q0, q1, 'a'));
+    trap.addTransition(trap.newTransition(q0, q2, 'b'));
+    trap.addTransition(trap.newTransition(q2, q2, 'b'));
+    return trap;
+}